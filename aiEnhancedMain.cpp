@@ -1,139 +1,147 @@
 #define SDL_MAIN_HANDLED
 #include "aiEnhancedScreen.h"
+#include "vec.h"
+#include "quaternion.h"
+#include "mesh.h"
+#include "depthBuffer.h"
+#include "lines.h"
+#include "strokes.h"
+#include "rasterizer.h"
+#include "transformCache.h"
+#include "polytope.h"
+#include "lod.h"
+#include "edgeOrder.h"
+#include "hypercube.h"
+#include "camera4D.h"
+#include "curves.h"
+#include "resolution.h"
+#include "qualityGovernor.h"
 #include <cmath>
 #include <algorithm>
 #include <chrono>
-
-// Define a 4D vector
-struct Vec4 {
-    float x, y, z, w;
-};
-
-// Define a 3D vector
-struct Vec3 {
-    float x, y, z;
-};
-
-// Define a quaternion for rotation
-struct Quaternion {
-    float w, x, y, z;
-
-    Quaternion() : w(1), x(0), y(0), z(0) {}
-    Quaternion(float w_, float x_, float y_, float z_) : w(w_), x(x_), y(y_), z(z_) {}
-
-    Quaternion operator*(const Quaternion& q) const {
-        return Quaternion(
-            w*q.w - x*q.x - y*q.y - z*q.z,
-            w*q.x + x*q.w + y*q.z - z*q.y,
-            w*q.y - x*q.z + y*q.w + z*q.x,
-            w*q.z + x*q.y - y*q.x + z*q.w
-        );
-    }
-
-    Vec3 rotate(const Vec3& v) const {
-        Quaternion p(0, v.x, v.y, v.z);
-        Quaternion q = (*this) * p * conjugate();
-        return Vec3{q.x, q.y, q.z};
-    }
-
-    Quaternion conjugate() const {
-        return Quaternion(w, -x, -y, -z);
-    }
-};
-
-// Create a quaternion from angle and axis
-Quaternion angleAxis(float angle, const Vec3& axis) {
-    float s = std::sin(angle / 2);
-    float c = std::cos(angle / 2);
-    return Quaternion(c, axis.x * s, axis.y * s, axis.z * s);
-}
+#include <fstream>
 
 // Define projection parameters
 constexpr float FOV = 60.0f; // Field of view in degrees
-constexpr float NEAR_PLANE = 0.1f;
-constexpr float FAR_PLANE = 100.0f;
 
 // Define scaling factor to adjust cube size
 constexpr float DEG2RAD = M_PI / 180.0f;
 
-// Function to project 4D point to 3D
-Vec3 project4Dto3D(const Vec4& v, float wAngle) {
-    // Rotate in the 4th dimension (w)
-    float c = std::cos(wAngle);
-    float s = std::sin(wAngle);
-
-    float x = v.x * c - v.w * s;
-    float w = v.x * s + v.w * c;
-
-    return Vec3{x, v.y, v.z};
-}
+// Draws an N-dimensional polytope: Givens rotations in N dimensions, N -> 3 perspective chain,
+// then the same 3D rotation and projection as the hypercube. Buffers are reused across frames.
+// The polytope comes with a LOD chain; each frame draws the coarsest level whose error stays
+// under errorPixels at the size the polytope had on screen the frame before.
+// Edges go out as generated, or sorted by projected midpoint every frame (edgeOrder.h). The
+// polytope turns in N dimensions every frame, so a one-time object-space order would not match
+// the screen and is not offered.
+struct PolytopeRenderer {
+    static constexpr float DISTANCE = 3.0f; // per-dimension eye distance for the perspective chain
+
+    std::vector<LodLevel> lods;
+    LodSelector selector;
+    float pixelsPerUnit = 0; // on-screen radius of the unit-radius polytope, from the last frame
+
+    Polytope rotated;
+    std::vector<PlaneRotation> rotations;
+    std::vector<Vec3> points;
+    std::vector<float> scratch;
+
+    EdgeOrdering ordering = EdgeOrdering::AsGiven; // AsGiven or ScreenMorton
+    FrameArena arena;
+
+    // Build the LOD chain, once per polytope
+    void setPolytope(const Polytope& polytope) {
+        lods = buildLodChain(polytope);
+        selector.reset();
+        pixelsPerUnit = 0;
+    }
 
-// Function to project 3D point to 2D
-Vec3 project3Dto2D(const Vec3& v, float fov, float aspect, float near, float far, float scale) {
-    float fov_rad = fov * DEG2RAD;
-    float tan_half_fov = std::tan(fov_rad / 2);
-    float z_range = far - near;
+    // Lines go into fb when it is given (the software raster path), otherwise through SDL
+    void draw(SDL_Renderer* renderer, Framebuffer* fb, float time, const Quaternion& rotation, const Camera3D& camera, float depth,
+              float errorPixels) {
+        const Polytope& base = lods[pixelsPerUnit > 0 ? selector.select(lods, pixelsPerUnit, errorPixels) : 0].mesh;
 
-    // Prevent division by zero
-    if (v.z == 0) return Vec3{0, 0, 0};
+        // Spin every extra axis against one of x, y, z at its own rate
+        rotations.clear();
+        for (int d = 3; d < base.dimension; ++d) {
+            rotations.push_back(PlaneRotation{d % 3, d, time * (0.3f + 0.05f * d)});
+        }
 
-    float x = (v.x / (v.z * tan_half_fov)) * scale;
-    float y = (v.y / (v.z * tan_half_fov * aspect)) * scale;
-    float z = (v.z - near) / z_range * 2.0f - 1.0f;
+        rotated.dimension = base.dimension;
+        rotated.count = base.count;
+        rotated.coords = base.coords;
+        rotatePlanes(rotated, rotations);
+        projectTo3D(rotated, DISTANCE, points, scratch);
+        rotation.rotate(points);
+
+        // The center projects to the viewport center; the farthest vertex from it gives the size
+        Vec3 center = camera.project(0, 0, depth);
+        float radius2 = 0;
+        for (Vec3& p : points) {
+            p = p * 1.1f;
+            p = camera.project(p.x, p.y, p.z + depth);
+            float dx = p.x - center.x, dy = p.y - center.y;
+            radius2 = std::max(radius2, dx * dx + dy * dy);
+        }
+        pixelsPerUnit = std::sqrt(radius2);
 
-    return Vec3{x, y, z};
-}
+        const uint32_t* order = nullptr;
+        if (ordering == EdgeOrdering::ScreenMorton) {
+            arena.reset();
+            order = mortonEdgeOrder(base.edges, points.data(), arena);
+        }
 
-// Function to draw a line with specified color
-void drawLine(SDL_Renderer* renderer, const Vec3& start, const Vec3& end, int r, int g, int b) {
-    SDL_SetRenderDrawColor(renderer, r, g, b, 255);
-    SDL_RenderDrawLineF(renderer, start.x, start.y, end.x, end.y);
-}
+        uint32_t color = packColor(100, 200, 255);
+        SDL_SetRenderDrawColor(renderer, 100, 200, 255, 255);
+        for (size_t i = 0; i < base.edges.size(); ++i) {
+            const auto& edge = base.edges[order ? order[i] : i];
+            const Vec3& a = points[edge.first];
+            const Vec3& b = points[edge.second];
+            if (fb) drawLineGradient(*fb, a.x, a.y, b.x, b.y, color, color);
+            else SDL_RenderDrawLineF(renderer, a.x, a.y, b.x, b.y);
+        }
+    }
+};
 
 int main() {
     Screen screen;
     SDL_Renderer* renderer = screen.getRenderer();
 
-    // Define the cube's vertices in 4D space (tesseract)
-    std::vector<Vec4> hypercubeVertices = {
-        {-0.5f, -0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f, -0.5f},
-        {0.5f,  0.5f, -0.5f, -0.5f}, {-0.5f,  0.5f, -0.5f, -0.5f},
-        {-0.5f, -0.5f,  0.5f, -0.5f}, {0.5f, -0.5f,  0.5f, -0.5f},
-        {0.5f,  0.5f,  0.5f, -0.5f}, {-0.5f,  0.5f,  0.5f, -0.5f},
-        {-0.5f, -0.5f, -0.5f,  0.5f}, {0.5f, -0.5f, -0.5f,  0.5f},
-        {0.5f,  0.5f, -0.5f,  0.5f}, {-0.5f,  0.5f, -0.5f,  0.5f},
-        {-0.5f, -0.5f,  0.5f,  0.5f}, {0.5f, -0.5f,  0.5f,  0.5f},
-        {0.5f,  0.5f,  0.5f,  0.5f}, {-0.5f,  0.5f,  0.5f,  0.5f}
-    };
-
-    // Scale the cube by a factor of 1.3
-    for (auto& vertex : hypercubeVertices) {
-        vertex.x *= 1.3f;
-        vertex.y *= 1.3f;
-        vertex.z *= 1.3f;
-        vertex.w *= 1.3f;
+    // The tesseract's vertices and edges are generated at compile time; scale the cube by a factor of 1.3
+    using Tesseract = Hypercube<4>;
+    std::vector<Vec4> hypercubeVertices;
+    hypercubeVertices.reserve(Tesseract::VERTEX_COUNT);
+    for (const auto& vertex : Tesseract::vertices) {
+        Vec<4> scaled = vertex * 1.3f;
+        hypercubeVertices.push_back(Vec4{scaled[0], scaled[1], scaled[2], scaled[3]});
     }
 
     // Define the hypercube's edges
-    std::vector<std::pair<int, int>> hypercubeEdges = {
-        {0,1},{1,2},{2,3},{3,0},
-        {4,5},{5,6},{6,7},{7,4},
-        {0,4},{1,5},{2,6},{3,7},
-        {0,8},{1,9},{2,10},{3,11},
-        {4,12},{5,13},{6,14},{7,15},
-        {8,9},{9,10},{10,11},{11,8},
-        {12,13},{13,14},{14,15},{15,12},
-        {8,12},{9,13},{10,14},{11,15}
-    };
+    std::vector<std::pair<int, int>> hypercubeEdges(Tesseract::edges.begin(), Tesseract::edges.end());
+
+    // Square faces of the hypercube, used as occluders in hidden-line mode and for filled rendering
+    std::vector<Face> hypercubeFaces = buildHypercubeFaces(hypercubeVertices);
+
+    // Wind the faces outward as seen in the 3D viewports (w dropped) and record which faces meet at each edge
+    std::vector<Vec3> cubePositions;
+    for (const auto& vertex : hypercubeVertices) cubePositions.push_back(Vec3{vertex.x, vertex.y, vertex.z});
+    orientFacesOutward(hypercubeFaces, cubePositions);
+    EdgeAdjacency hypercubeAdjacency = buildEdgeAdjacency(hypercubeEdges, hypercubeFaces);
 
-    // Define colors for vertices
+    // Define colors for vertices, in the generator's order (bit d of the index set = positive on axis d)
     std::vector<SDL_Color> vertexColors = {
-        {255,0,0,255}, {0,255,0,255}, {0,0,255,255}, {255,255,0,255},
-        {255,0,255,255}, {0,255,255,255}, {255,128,0,255}, {128,0,255,255},
-        {255,255,255,255}, {128,128,128,255}, {64,64,64,255}, {192,192,192,255},
-        {0,0,0,255}, {255,128,128,255}, {128,255,128,255}, {128,128,255,255}
+        {255,0,0,255}, {0,255,0,255}, {255,255,0,255}, {0,0,255,255},
+        {255,0,255,255}, {0,255,255,255}, {128,0,255,255}, {255,128,0,255},
+        {255,255,255,255}, {128,128,128,255}, {192,192,192,255}, {64,64,64,255},
+        {0,0,0,255}, {255,128,128,255}, {128,128,255,255}, {128,255,128,255}
     };
 
+    // Edge colors (the average of the two vertex colors) are fixed, so compute them once and group
+    // the edges into per-color runs
+    std::vector<uint32_t> packedVertexColors;
+    for (const SDL_Color& c : vertexColors) packedVertexColors.push_back(packColor(c.r, c.g, c.b, c.a));
+    EdgeColorRuns edgeRuns = buildEdgeColorRuns(hypercubeEdges, packedVertexColors);
+
     // Calculate scale factor based on viewport size and FOV
     constexpr float TARGET_HEIGHT_RATIO = 0.6f; // 60% of viewport height
     float tan_half_fov = std::tan((FOV * DEG2RAD) / 2);
@@ -142,35 +150,198 @@ int main() {
     // Adjust the scale by 1.3 to make the cube appear larger
     scale *= 1.3f;
 
+    // Move the cube slightly back to ensure it's fully visible
+    Camera3D camera3D = Camera3D::perspective(FOV, scale, 2.0f, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+
+    // Eye distance along w for the 4D quadrants
+    constexpr float W_DISTANCE = 3.0f;
+
+    // The projection kernel reads the vertices as structure-of-arrays
+    Vec4Soa hypercubeSoa;
+    for (const auto& vertex : hypercubeVertices) hypercubeSoa.push_back(vertex);
+
+    // Per-viewport outputs, reused every frame: screen x, y and 1/z, plus view-space positions for culling
+    std::vector<Vec3> projectedPoints(hypercubeVertices.size());
+    std::vector<Vec3> viewPoints;
+
+    // Connected edges of one color run, drawn with a single SDL_RenderDrawLinesF call
+    std::vector<SDL_FPoint> polyline;
+    auto flushPolyline = [&]() {
+        if (polyline.size() >= 2) SDL_RenderDrawLinesF(renderer, polyline.data(), static_cast<int>(polyline.size()));
+        polyline.clear();
+    };
+
+    // Hidden-line removal (toggle with H) draws the edges through a depth buffer into the software framebuffer
+    bool hiddenLineRemoval = false;
+    DepthBuffer depthBuffer(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    Framebuffer& framebuffer = screen.framebuffer();
+
+    // Gradient edges (toggle with G) draw the wireframe through the framebuffer, which can blend
+    // the two vertex colors along each edge; SDL lines only take one color
+    bool gradientEdges = false;
+
+    // Thick edges (toggle with T) fill each edge as spans, wider the nearer it is. Spans carry no
+    // depth, so they only replace the plain wireframe; the depth-tested modes keep 1px lines.
+    constexpr float THICK_EDGE_WIDTH = 3.0f; // width in pixels at the cube's center depth
+    bool thickEdges = false;
+
+    // Filled faces (F cycles wireframe -> flat -> smooth) go through the same depth buffer
+    enum class FaceMode { Wireframe, Flat, Smooth };
+    FaceMode faceMode = FaceMode::Wireframe;
+    TriangleRasterizer rasterizer;
+
+    // Edge culling (B cycles all edges -> front-face edges -> silhouette) for the 3D cube viewports
+    EdgeMode edgeMode = EdgeMode::All;
+    std::vector<int8_t> faceFacing;
+
+    TransformCache transformCache;
+
+    // N-dimensional polytope in quadrant 4 (N toggles, Up/Down change the dimension, K cycles cube/simplex/cross,
+    // O toggles sorting its edges by screen Morton order every frame)
+    bool showPolytope = false;
+    int polytopeDimension = 5;
+    int polytopeKind = 0;
+    Polytope polytope = makeHypercube(polytopeDimension);
+    PolytopeRenderer polytopeRenderer;
+    polytopeRenderer.setPolytope(polytope);
+
+    // Page Up/Down push the polytope away or pull it back, which lets the LOD chain show; the
+    // governor's LOD knob accepts coarser levels
+    constexpr float POLYTOPE_DEPTH = 0.5f, MAX_POLYTOPE_DEPTH = 512.0f;
+    constexpr float LOD_ERROR_PIXELS = 1.0f, REDUCED_LOD_ERROR_PIXELS = 8.0f;
+    float polytopeDepth = POLYTOPE_DEPTH;
+
+    // The SDL path draws the quadrant-2 sphere as one polyline; its radius pulses, so the
+    // tessellations are cached by quantized radius
+    CurveCache curveCache;
+    std::vector<SDL_FPoint> spherePoints;
+
+    // Frame budget: 60 fps, measured as render time before present
+    constexpr float FRAME_BUDGET_MS = 1000.0f / 60;
+
+    // Dynamic resolution (toggle with R): the internal render size follows the frame time
+    ResolutionController resolution(FRAME_BUDGET_MS);
+    bool dynamicResolution = true;
+
+    // Once resolution is at its minimum, the governor switches features down (and back up when
+    // resolution is full again), logging each decision to qualityGovernor.csv
+    std::ofstream governorLog("qualityGovernor.csv");
+    QualityGovernor governor(FRAME_BUDGET_MS, governorLog ? &governorLog : nullptr);
+    FrameTimer frameTimer;
+    constexpr float COARSE_CURVE_TOLERANCE = 4 * CURVE_TOLERANCE;
+
     auto start_time = std::chrono::high_resolution_clock::now();
 
     while (!screen.shouldQuit()) {
+        if (screen.keyPressed(SDLK_h)) hiddenLineRemoval = !hiddenLineRemoval;
+        if (screen.keyPressed(SDLK_b)) edgeMode = static_cast<EdgeMode>((static_cast<int>(edgeMode) + 1) % 3);
+        if (screen.keyPressed(SDLK_g)) gradientEdges = !gradientEdges;
+        if (screen.keyPressed(SDLK_t)) thickEdges = !thickEdges;
+        if (screen.keyPressed(SDLK_l)) {
+            Framebuffer& fb = screen.framebuffer();
+            fb.setLayout(fb.layout() == FramebufferLayout::Linear ? FramebufferLayout::Tiled : FramebufferLayout::Linear);
+        }
+        if (screen.keyPressed(SDLK_r)) {
+            dynamicResolution = !dynamicResolution;
+            resolution.reset();
+        }
+        if (screen.keyPressed(SDLK_f)) faceMode = static_cast<FaceMode>((static_cast<int>(faceMode) + 1) % 3);
+        if (screen.keyPressed(SDLK_n)) showPolytope = !showPolytope;
+        bool polytopeChanged = false;
+        if (screen.keyPressed(SDLK_UP) && polytopeDimension < MAX_POLYTOPE_DIMENSION) {
+            polytopeDimension++;
+            polytopeChanged = true;
+        }
+        if (screen.keyPressed(SDLK_DOWN) && polytopeDimension > 3) {
+            polytopeDimension--;
+            polytopeChanged = true;
+        }
+        if (screen.keyPressed(SDLK_o)) {
+            polytopeRenderer.ordering = polytopeRenderer.ordering == EdgeOrdering::AsGiven ? EdgeOrdering::ScreenMorton : EdgeOrdering::AsGiven;
+        }
+        if (screen.keyPressed(SDLK_k)) {
+            polytopeKind = (polytopeKind + 1) % 3;
+            polytopeChanged = true;
+        }
+        if (polytopeChanged) {
+            polytope = polytopeKind == 0 ? makeHypercube(polytopeDimension)
+                     : polytopeKind == 1 ? makeSimplex(polytopeDimension)
+                     : makeCrossPolytope(polytopeDimension);
+            polytopeRenderer.setPolytope(polytope);
+        }
+        if (screen.keyPressed(SDLK_PAGEUP)) polytopeDepth = std::min(polytopeDepth * 2 + 1, MAX_POLYTOPE_DEPTH);
+        if (screen.keyPressed(SDLK_PAGEDOWN)) polytopeDepth = std::max((polytopeDepth - 1) / 2, POLYTOPE_DEPTH);
+
+        // The features in use this frame, minus what the governor has switched off. Filled faces
+        // always need the depth test, so the governor only gives up hidden-line removal.
+        bool filledFaces = faceMode != FaceMode::Wireframe;
+        governor.setActive(QualityKnob::GradientColors, gradientEdges);
+        governor.setActive(QualityKnob::DepthTest, hiddenLineRemoval && !filledFaces);
+        bool useGradients = gradientEdges && governor.enabled(QualityKnob::GradientColors);
+        bool useHiddenLines = hiddenLineRemoval && governor.enabled(QualityKnob::DepthTest);
+
+        bool depthTest = useHiddenLines || filledFaces;
+        bool softwareRaster = depthTest || useGradients || thickEdges;
+
+        governor.setActive(QualityKnob::LevelOfDetail, showPolytope);
+        float lodErrorPixels = governor.enabled(QualityKnob::LevelOfDetail) ? LOD_ERROR_PIXELS : REDUCED_LOD_ERROR_PIXELS;
+
+        // Only the SDL sphere is tessellated
+        governor.setActive(QualityKnob::CurveDetail, !softwareRaster);
+        curveCache.setTolerance(governor.enabled(QualityKnob::CurveDetail) ? CURVE_TOLERANCE : COARSE_CURVE_TOLERANCE);
+
+        frameTimer.begin();
         auto current_time = std::chrono::high_resolution_clock::now();
         float time = std::chrono::duration<float>(current_time - start_time).count();
 
+        // Everything below works at the internal resolution; renderScale maps full-resolution sizes to it
+        screen.setRenderSize(resolution.size(WINDOW_WIDTH), resolution.size(WINDOW_HEIGHT));
+        int viewportWidth = screen.renderWidth() / VIEWPORT_COLUMNS;
+        int viewportHeight = screen.renderHeight() / VIEWPORT_ROWS;
+        float renderScale = static_cast<float>(viewportHeight) / VIEWPORT_HEIGHT;
+        camera3D = Camera3D::perspective(FOV, scale * renderScale, 2.0f, viewportWidth, viewportHeight);
+        if (depthBuffer.width() != viewportWidth || depthBuffer.height() != viewportHeight) {
+            depthBuffer.resize(viewportWidth, viewportHeight);
+        }
+
         // Define rotation angles
         float rot_x = 0.5f * time;
         float rot_y = 0.3f * time;
         float rot_z = 0.2f * time;
         float rot_w = 0.7f * time; // Rotation in the 4th dimension
 
+        // Rotations are the same for every viewport, build them once per frame
+        Quaternion baseRotation = angleAxis(rot_x, Vec3{1, 0, 0}) *
+                                  angleAxis(rot_y, Vec3{0, 1, 0}) *
+                                  angleAxis(rot_z, Vec3{0, 0, 1});
+        Quaternion fastRotation = angleAxis(rot_x * 2, Vec3{1, 0, 0}) *
+                                  angleAxis(rot_y * 2, Vec3{0, 1, 0}) *
+                                  angleAxis(rot_z * 2, Vec3{0, 0, 1});
+        transformCache.newFrame();
+
         // Clear the renderer
+        screen.beginFrame();
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
+        if (softwareRaster) framebuffer.clear();
 
         // Iterate through each viewport (quadrant)
         for (int viewport = 0; viewport < 4; ++viewport) {
             // Calculate viewport position
-            int vx = (viewport % VIEWPORT_COLUMNS) * VIEWPORT_WIDTH;
-            int vy = (viewport / VIEWPORT_COLUMNS) * VIEWPORT_HEIGHT;
+            int vx = (viewport % VIEWPORT_COLUMNS) * viewportWidth;
+            int vy = (viewport / VIEWPORT_COLUMNS) * viewportHeight;
 
-            SDL_Rect viewportRect = {vx, vy, VIEWPORT_WIDTH, VIEWPORT_HEIGHT};
+            SDL_Rect viewportRect = {vx, vy, viewportWidth, viewportHeight};
             SDL_RenderSetViewport(renderer, &viewportRect);
-
-            // Create rotation quaternion
-            Quaternion rotation = angleAxis(rot_x, Vec3{1, 0, 0}) *
-                                  angleAxis(rot_y, Vec3{0, 1, 0}) *
-                                  angleAxis(rot_z, Vec3{0, 0, 1});
+            framebuffer.setViewport(vx, vy, viewportWidth, viewportHeight);
+
+            if (viewport == 3 && showPolytope) {
+                frameTimer.lap(FrameStage::Transform);
+                polytopeRenderer.draw(renderer, softwareRaster ? &framebuffer : nullptr, time, baseRotation, camera3D, polytopeDepth,
+                                      lodErrorPixels);
+                frameTimer.lap(FrameStage::Edges);
+                continue;
+            }
 
             // Adjust rotation and 4D projection based on viewport
             bool use4D = false;
@@ -181,104 +352,137 @@ int main() {
             }
 
             // For quadrant 2, create an impressive effect
-            if (viewport == 1) {
-                rotation = angleAxis(rot_x * 2, Vec3{1, 0, 0}) *
-                           angleAxis(rot_y * 2, Vec3{0, 1, 0}) *
-                           angleAxis(rot_z * 2, Vec3{0, 0, 1});
+            const Quaternion& rotation = viewport == 1 ? fastRotation : baseRotation;
+
+            // 4D rotation plus a true perspective divide along w for the 4D quadrants
+            Rotation4D rotation4D;
+            Camera4D camera4D{0.0f}; // the 3D quadrants drop w
+            if (use4D) {
+                rotation4D.axis = viewport == 0 ? 0 : 1; // x-w or y-w plane
+                rotation4D.angle = rot_w;
+                camera4D.wDistance = W_DISTANCE;
             }
 
-            // Vector to store projected points
-            std::vector<Vec3> projectedPoints;
-            projectedPoints.reserve(hypercubeVertices.size());
-
-            for (size_t i = 0; i < hypercubeVertices.size(); ++i) {
-                Vec4 point = hypercubeVertices[i];
-                Vec3 projected3D;
-
-                if (use4D) {
-                    // Rotate in 4D
-                    if (viewport == 0) {
-                        // Rotate in x-w plane
-                        float c = std::cos(rot_w);
-                        float s = std::sin(rot_w);
-                        float x = point.x * c - point.w * s;
-                        float w = point.x * s + point.w * c;
-                        point.x = x;
-                        point.w = w;
-                    } else if (viewport == 2) {
-                        // Rotate in y-w plane
-                        float c = std::cos(rot_w);
-                        float s = std::sin(rot_w);
-                        float y = point.y * c - point.w * s;
-                        float w = point.y * s + point.w * c;
-                        point.y = y;
-                        point.w = w;
-                    }
-
-                    // Project from 4D to 3D
-                    projected3D = project4Dto3D(point, rot_w);
-                } else {
-                    // Discard w component
-                    projected3D = Vec3{point.x, point.y, point.z};
+            // The 3D rotation of the vertices comes from the cache: it is keyed on the mesh and the
+            // quaternion only, so quadrants 1, 3 and 4 (all baseRotation) rotate once per frame and
+            // only the 4D stage and camera run per viewport
+            TransformCache::Key key;
+            key.mesh = &hypercubeVertices;
+            key.transform = {rotation.w, rotation.x, rotation.y, rotation.z};
+
+            Mat3 rotationMatrix = rotation.toMatrix();
+            const std::vector<Vec3>& worldPoints = transformCache.get(key, [&](std::vector<Vec3>& out) {
+                out.resize(hypercubeSoa.size());
+                rotatePoints3D(hypercubeSoa, rotationMatrix, out.data());
+            });
+            if (use4D) {
+                project4D(hypercubeSoa, worldPoints.data(), rotation4D, camera4D, rotationMatrix, camera3D, projectedPoints.data());
+            } else {
+                projectPoints(worldPoints.data(), worldPoints.size(), camera3D, projectedPoints.data());
+            }
+            frameTimer.lap(FrameStage::Transform);
+
+            // Draw the faces into the depth buffer (and the framebuffer when filled) so edges behind them can be rejected
+            if (depthTest) {
+                auto vertex = [&](int i) {
+                    const Vec3& p = projectedPoints[i];
+                    const SDL_Color& c = vertexColors[i];
+                    return RasterVertex{p.x, p.y, p.z, static_cast<float>(c.r), static_cast<float>(c.g), static_cast<float>(c.b)};
+                };
+                Shading shading = faceMode == FaceMode::Flat ? Shading::Flat : Shading::Smooth;
+
+                depthBuffer.clear();
+                rasterizer.begin(viewportWidth, viewportHeight);
+                for (const auto& face : hypercubeFaces) {
+                    rasterizer.submit(vertex(face.a), vertex(face.b), vertex(face.c), shading);
+                    rasterizer.submit(vertex(face.a), vertex(face.c), vertex(face.d), shading);
                 }
-
-                // Apply rotation
-                Vec3 rotated = rotation.rotate(projected3D);
-
-                // Move the cube slightly back to ensure it's fully visible
-                rotated.z += 2.0f; // Adjusted from 3.0f to 4.0f to account for increased size
-
-                // Project the 3D point to 2D
-                Vec3 projected = project3Dto2D(rotated, FOV, static_cast<float>(VIEWPORT_WIDTH) / VIEWPORT_HEIGHT, NEAR_PLANE, FAR_PLANE, scale);
-
-                // Map projected coordinates to viewport center
-                float screen_x = projected.x + VIEWPORT_WIDTH / 2.0f;
-                float screen_y = -projected.y + VIEWPORT_HEIGHT / 2.0f; // Invert y-axis for correct orientation
-
-                projectedPoints.emplace_back(Vec3{screen_x, screen_y, projected.z});
+                rasterizer.flush(framebuffer, &depthBuffer, filledFaces);
+                depthBuffer.buildCoarse();
+                frameTimer.lap(FrameStage::Faces);
             }
 
-            // Draw the cube edges
-            for (const auto& edge : hypercubeEdges) {
-                const Vec3& start = projectedPoints[edge.first];
-                const Vec3& end = projectedPoints[edge.second];
-
-                // Use colors from vertices
-                SDL_Color colorStart = vertexColors[edge.first];
-                SDL_Color colorEnd = vertexColors[edge.second];
+            // The projected tesseract is not a closed 3D surface, so only the cube viewports cull edges
+            bool cullEdges = edgeMode != EdgeMode::All && !use4D;
+            if (cullEdges) {
+                viewPoints.clear();
+                for (const Vec3& p : worldPoints) viewPoints.push_back(Vec3{p.x, p.y, p.z + camera3D.zOffset});
+                classifyFaces(hypercubeFaces, viewPoints, faceFacing);
+            }
 
-                // Interpolate colors
-                int r = (colorStart.r + colorEnd.r) / 2;
-                int g = (colorStart.g + colorEnd.g) / 2;
-                int b = (colorStart.b + colorEnd.b) / 2;
+            // Draw the cube edges one color run at a time. The SDL path sets the color once per run
+            // and sends each chain of connected edges as a single polyline.
+            for (size_t r = 0; r + 1 < edgeRuns.offsets.size(); ++r) {
+                uint32_t color = edgeRuns.colors[r];
+                if (!softwareRaster) SDL_SetRenderDrawColor(renderer, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, 255);
+
+                int tail = -1;
+                for (int i = edgeRuns.offsets[r]; i < edgeRuns.offsets[r + 1]; ++i) {
+                    int e = edgeRuns.order[i];
+                    if (cullEdges && !edgeVisible(edgeMode, e, hypercubeAdjacency, faceFacing)) continue;
+
+                    int from = hypercubeEdges[e].first;
+                    int to = hypercubeEdges[e].second;
+                    if (softwareRaster) {
+                        const Vec3& a = projectedPoints[from];
+                        const Vec3& b = projectedPoints[to];
+                        if (thickEdges && !depthTest) {
+                            // Projected z is 1/z, so this scales the width with perspective; round caps close the corners
+                            float width = THICK_EDGE_WIDTH * renderScale * (a.z + b.z) * 0.5f * camera3D.zOffset;
+                            drawThickLine(framebuffer, a.x, a.y, b.x, b.y, width, color, LineCap::Round);
+                        } else if (!useGradients) {
+                            drawLineDepthTested(framebuffer, depthBuffer, a, b, color);
+                        } else if (depthTest) {
+                            drawLineGradientDepthTested(framebuffer, depthBuffer, a, b, packedVertexColors[from], packedVertexColors[to]);
+                        } else {
+                            drawLineGradient(framebuffer, a.x, a.y, b.x, b.y, packedVertexColors[from], packedVertexColors[to]);
+                        }
+                        continue;
+                    }
 
-                drawLine(renderer, start, end, r, g, b);
+                    if (to == tail) std::swap(from, to);
+                    if (from != tail) {
+                        flushPolyline();
+                        polyline.push_back(SDL_FPoint{projectedPoints[from].x, projectedPoints[from].y});
+                    }
+                    polyline.push_back(SDL_FPoint{projectedPoints[to].x, projectedPoints[to].y});
+                    tail = to;
+                }
+                flushPolyline();
             }
+            frameTimer.lap(FrameStage::Edges);
 
-            // For quadrant 2, add a "WOW" factor with a pulsating sphere
+            // For quadrant 2, add a "WOW" factor with a pulsating sphere: an anti-aliased midpoint circle
+            // when the framebuffer is in use, otherwise a polyline sized to the on-screen error
             if (viewport == 1) {
-                int numSegments = 100;
-                float radius = 150 + 50 * std::sin(time * 2);
-
-                SDL_SetRenderDrawColor(renderer, 255, 215, 0, 255); // Gold color
-
-                for (int i = 0; i < numSegments; ++i) {
-                    float theta1 = (2.0f * M_PI * i) / numSegments;
-                    float theta2 = (2.0f * M_PI * (i + 1)) / numSegments;
-
-                    float x1 = VIEWPORT_WIDTH / 2 + radius * std::cos(theta1);
-                    float y1 = VIEWPORT_HEIGHT / 2 + radius * std::sin(theta1);
+                float radius = (150 + 50 * std::sin(time * 2)) * renderScale;
 
-                    float x2 = VIEWPORT_WIDTH / 2 + radius * std::cos(theta2);
-                    float y2 = VIEWPORT_HEIGHT / 2 + radius * std::sin(theta2);
-
-                    SDL_RenderDrawLineF(renderer, x1, y1, x2, y2);
+                if (softwareRaster) {
+                    drawCircleAA(framebuffer, viewportWidth / 2.0f, viewportHeight / 2.0f, radius, packColor(255, 215, 0));
+                } else {
+                    spherePoints.clear();
+                    for (const Vec2& p : curveCache.circle(radius)) {
+                        spherePoints.push_back(SDL_FPoint{viewportWidth / 2.0f + p.x, viewportHeight / 2.0f + p.y});
+                    }
+                    SDL_SetRenderDrawColor(renderer, 255, 215, 0, 255); // Gold color
+                    SDL_RenderDrawLinesF(renderer, spherePoints.data(), static_cast<int>(spherePoints.size()));
                 }
+                frameTimer.lap(FrameStage::Curves);
             }
         }
 
-        // Present the rendered frame
-        SDL_RenderPresent(renderer);
+        if (softwareRaster) screen.drawFramebuffer();
+        frameTimer.lap(FrameStage::Present);
+
+        // Render time of this frame, before present and the frame cap so waiting is not counted.
+        // Resolution reacts first; the governor reduces only at minimum resolution and restores only at full.
+        float frameMs = frameTimer.end();
+        if (dynamicResolution) resolution.update(frameMs);
+        governor.update(frameTimer.timings, !dynamicResolution || resolution.atMinimum(),
+                        !dynamicResolution || resolution.atMaximum());
+
+        // Scale the frame up to the window and present it
+        screen.present();
 
         // Delay to cap at ~60 FPS
         SDL_Delay(16);
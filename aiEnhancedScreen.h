@@ -1,5 +1,8 @@
 #pragma once
 #include <SDL2/SDL.h>
+#include "framebuffer.h"
+#include "circles.h"
+#include <algorithm>
 #include <vector>
 #include <iostream>
 
@@ -13,11 +16,19 @@ constexpr int VIEWPORT_ROWS = 2;
 constexpr int VIEWPORT_WIDTH = WINDOW_WIDTH / VIEWPORT_COLUMNS;   // 640
 constexpr int VIEWPORT_HEIGHT = WINDOW_HEIGHT / VIEWPORT_ROWS;     // 480
 
+// Frames render at an internal resolution (renderWidth() x renderHeight(), at most the window
+// size) into an offscreen target and are scaled up to the window once, in present().
+// Everything drawn between beginFrame() and present() uses render-resolution coordinates.
 class Screen {
     SDL_Event e;
     SDL_Window* window;
     SDL_Renderer* renderer;
+    SDL_Texture* texture;
+    SDL_Texture* target = nullptr; // null when the renderer cannot render to textures
     std::vector<SDL_FPoint> points;
+    std::vector<SDL_Keycode> pressedKeys;
+    Framebuffer fb{WINDOW_WIDTH, WINDOW_HEIGHT};
+    int renderW = WINDOW_WIDTH, renderH = WINDOW_HEIGHT;
 
 public:
     Screen() {
@@ -34,9 +45,29 @@ public:
 
         // Set logical size to handle high-DPI displays if necessary
         SDL_RenderSetLogicalSize(renderer, WINDOW_WIDTH, WINDOW_HEIGHT);
+
+        // Streaming texture for the software raster paths, blended so untouched pixels stay transparent
+        texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, WINDOW_WIDTH, WINDOW_HEIGHT);
+        if (!texture) {
+            std::cerr << "Texture could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+            SDL_DestroyRenderer(renderer);
+            SDL_DestroyWindow(window);
+            SDL_Quit();
+            exit(1);
+        }
+        SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+        // Window-sized target, frames use its top-left renderW x renderH corner so changing the
+        // resolution never reallocates it. Without target support frames stay at window size.
+        if (SDL_RenderTargetSupported(renderer)) {
+            target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, WINDOW_HEIGHT);
+        }
+        if (!target) std::cerr << "Render targets unavailable, rendering at window resolution" << std::endl;
     }
 
     ~Screen() {
+        if (target) SDL_DestroyTexture(target);
+        SDL_DestroyTexture(texture);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();
@@ -47,6 +78,25 @@ public:
         points.emplace_back(point);
     }
 
+    // Midpoint circle, ellipse and arc outlines, collected as points for drawPoints()
+    void circle(int cx, int cy, int r) {
+        rasterCircle(cx, cy, r, [this](int x, int y) { pixel(static_cast<float>(x), static_cast<float>(y)); });
+    }
+
+    void ellipse(int cx, int cy, int rx, int ry) {
+        rasterEllipse(cx, cy, rx, ry, [this](int x, int y) { pixel(static_cast<float>(x), static_cast<float>(y)); });
+    }
+
+    void arc(int cx, int cy, int r, float startAngle, float sweepAngle) {
+        rasterArc(cx, cy, r, startAngle, sweepAngle, [this](int x, int y) { pixel(static_cast<float>(x), static_cast<float>(y)); });
+    }
+
+    // Draw the collected points in the current color and viewport with one SDL call, then clear them
+    void drawPoints() {
+        SDL_RenderDrawPointsF(renderer, points.data(), static_cast<int>(points.size()));
+        points.clear();
+    }
+
     void show() {
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
@@ -63,6 +113,7 @@ public:
     }
 
     bool shouldQuit() {
+        pressedKeys.clear();
         while (SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT) {
                 return true;
@@ -70,9 +121,59 @@ public:
             if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) {
                 return true;
             }
+            if (e.type == SDL_KEYDOWN && !e.key.repeat) {
+                pressedKeys.push_back(e.key.keysym.sym);
+            }
         }
         return false;
     }
 
+    // True if the key went down since the last shouldQuit() call
+    bool keyPressed(SDL_Keycode key) const {
+        return std::find(pressedKeys.begin(), pressedKeys.end(), key) != pressedKeys.end();
+    }
+
+    Framebuffer& framebuffer() { return fb; }
+
+    // Internal resolution for the next frames, clamped to the window. The framebuffer follows it.
+    void setRenderSize(int w, int h) {
+        if (!target) return;
+        w = std::clamp(w, 1, WINDOW_WIDTH);
+        h = std::clamp(h, 1, WINDOW_HEIGHT);
+        if (w == renderW && h == renderH) return;
+        renderW = w;
+        renderH = h;
+        fb.resize(w, h);
+    }
+
+    int renderWidth() const { return renderW; }
+    int renderHeight() const { return renderH; }
+
+    // Point the renderer at the internal target, call before drawing a frame
+    void beginFrame() {
+        if (target) SDL_SetRenderTarget(renderer, target);
+        SDL_RenderSetViewport(renderer, nullptr);
+    }
+
+    // Upload the software framebuffer and draw it over everything rendered so far
+    void drawFramebuffer() {
+        fb.resetViewport();
+        SDL_Rect area = {0, 0, renderW, renderH};
+        SDL_UpdateTexture(texture, &area, fb.linearData(), fb.pitch());
+        SDL_RenderSetViewport(renderer, nullptr);
+        SDL_RenderCopy(renderer, texture, &area, &area);
+    }
+
+    // Scale the frame up to the window in one copy and show it
+    void present() {
+        if (target) {
+            SDL_Rect area = {0, 0, renderW, renderH};
+            SDL_SetRenderTarget(renderer, nullptr);
+            SDL_RenderSetViewport(renderer, nullptr);
+            SDL_RenderCopy(renderer, target, &area, nullptr);
+        }
+        SDL_RenderPresent(renderer);
+    }
+
     SDL_Renderer* getRenderer() { return renderer; }
 };
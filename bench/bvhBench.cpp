@@ -0,0 +1,138 @@
+// Bvh queries against brute-force scans over the same boxes: frustum culling, range queries and
+// ray picks, plus build and refit times. Every query's result is checked against the scan.
+// Build with "make bench" and run bvhBench.
+#include "../bvh.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+constexpr int OBJECTS = 100000;
+constexpr int QUERIES = 256;
+constexpr int RUNS = 5;
+
+// Best of RUNS, in microseconds per call of fn (which runs count calls)
+template <typename Fn>
+double timePer(int count, Fn&& fn) {
+    double best = 1e30;
+    for (int run = 0; run < RUNS; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, us / count);
+    }
+    return best;
+}
+
+// The test Bvh::cullFrustum applies to leaf objects: outside when the box's farthest corner along
+// some plane's normal is behind that plane
+bool outside(const Frustum& frustum, const AABB& b) {
+    for (const Plane& p : frustum.planes) {
+        Vec3 far{p.normal.x > 0 ? b.max.x : b.min.x, p.normal.y > 0 ? b.max.y : b.min.y, p.normal.z > 0 ? b.max.z : b.min.z};
+        if (dot(p.normal, far) + p.d < 0) return true;
+    }
+    return false;
+}
+
+void report(const char* name, double brute, double bvh, bool agree) {
+    std::printf("%-10s %12.1f %12.1f %9.1fx %8s\n", name, brute, bvh, brute / bvh, agree ? "yes" : "NO");
+}
+
+int main() {
+    // Boxes of 0.1 to 2 units in front of a camera at the origin looking down +z
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    auto randomBox = [&] {
+        Vec3 c{unit(rng) * 200 - 100, unit(rng) * 200 - 100, unit(rng) * 200};
+        Vec3 half{0.05f + unit(rng) * 0.95f, 0.05f + unit(rng) * 0.95f, 0.05f + unit(rng) * 0.95f};
+        return AABB{c - half, c + half};
+    };
+    std::vector<AABB> boxes(OBJECTS);
+    for (AABB& b : boxes) b = randomBox();
+
+    Bvh bvh;
+    double build = timePer(1, [&] { bvh.build(boxes); });
+    std::printf("%d objects, build %.2f ms\n\n", OBJECTS, build / 1000);
+    std::printf("%-10s %12s %12s %10s %8s\n", "query", "scan us", "bvh us", "speedup", "agree");
+
+    // Frusta from a narrow zoom to a wide view
+    std::vector<Frustum> frusta;
+    for (int q = 0; q < QUERIES; ++q) {
+        float tanHalf = 0.05f + unit(rng) * 0.95f;
+        frusta.push_back(Frustum::perspective(tanHalf, tanHalf * 0.75f, 0.1f, 50 + unit(rng) * 150));
+    }
+    std::vector<size_t> scanCounts(QUERIES), bvhCounts(QUERIES);
+    double scan = timePer(QUERIES, [&] {
+        for (int q = 0; q < QUERIES; ++q) {
+            scanCounts[q] = 0;
+            for (const AABB& b : boxes) scanCounts[q] += !outside(frusta[q], b);
+        }
+    });
+    double tree = timePer(QUERIES, [&] {
+        for (int q = 0; q < QUERIES; ++q) {
+            bvhCounts[q] = 0;
+            bvh.cullFrustum(frusta[q], [&](int) { bvhCounts[q]++; });
+        }
+    });
+    report("frustum", scan, tree, scanCounts == bvhCounts);
+
+    // Boxes of 1 to 20 units
+    std::vector<AABB> ranges;
+    for (int q = 0; q < QUERIES; ++q) {
+        Vec3 c{unit(rng) * 200 - 100, unit(rng) * 200 - 100, unit(rng) * 200};
+        float half = 0.5f + unit(rng) * 9.5f;
+        ranges.push_back(AABB{c - Vec3{half, half, half}, c + Vec3{half, half, half}});
+    }
+    scan = timePer(QUERIES, [&] {
+        for (int q = 0; q < QUERIES; ++q) {
+            scanCounts[q] = 0;
+            for (const AABB& b : boxes) scanCounts[q] += b.overlaps(ranges[q]);
+        }
+    });
+    tree = timePer(QUERIES, [&] {
+        for (int q = 0; q < QUERIES; ++q) {
+            bvhCounts[q] = 0;
+            bvh.queryRange(ranges[q], [&](int) { bvhCounts[q]++; });
+        }
+    });
+    report("range", scan, tree, scanCounts == bvhCounts);
+
+    // Rays from the camera through random points of a 90 degree view, as mouse picks would be
+    std::vector<Ray> rays;
+    for (int q = 0; q < QUERIES; ++q) rays.emplace_back(Vec3{0, 0, 0}, Vec3{unit(rng) * 2 - 1, unit(rng) * 2 - 1, 1});
+    std::vector<int> scanHits(QUERIES), bvhHits(QUERIES);
+    scan = timePer(QUERIES, [&] {
+        for (int q = 0; q < QUERIES; ++q) {
+            float nearest = FLT_MAX;
+            scanHits[q] = -1;
+            for (int i = 0; i < OBJECTS; ++i) {
+                float t = rays[q].intersect(boxes[i], nearest);
+                if (t >= 0 && t < nearest) {
+                    nearest = t;
+                    scanHits[q] = i;
+                }
+            }
+        }
+    });
+    tree = timePer(QUERIES, [&] {
+        float t;
+        for (int q = 0; q < QUERIES; ++q) bvhHits[q] = bvh.pick(rays[q], t);
+    });
+    report("pick", scan, tree, scanHits == bvhHits);
+
+    // 1% of the objects move a little each frame: refit against a full rebuild
+    std::vector<AABB> moved = boxes;
+    double refit = timePer(1, [&] {
+        for (int i = 0; i < OBJECTS; i += 100) {
+            Vec3 shift{unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f};
+            moved[i] = AABB{moved[i].min + shift, moved[i].max + shift};
+            bvh.update(i, moved[i]);
+        }
+        bvh.refit();
+    });
+    Bvh rebuilt;
+    double rebuild = timePer(1, [&] { rebuilt.build(moved); });
+    std::printf("\n%d moved objects: refit %.1f us, rebuild %.1f us\n", OBJECTS / 100, refit, rebuild);
+}
@@ -0,0 +1,187 @@
+// Linear against tiled (Morton) framebuffer layout on dense edges at random orientations, and
+// edges in submission order against edges sorted by midpoint Morton code (edgeOrder.h).
+// Build with "make bench" and run framebufferBench.
+//
+// Times the real line rasterizers, and counts cache misses by replaying each line's pixel
+// addresses through a simulated L1 (32 KB, 8-way, 64-byte lines, LRU), so the miss counts
+// do not depend on the machine or on access to hardware counters.
+#include "../edgeOrder.h"
+#include "../lines.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+constexpr int WIDTH = 1280;
+constexpr int HEIGHT = 960;
+constexpr int EDGES = 20000;
+constexpr int RUNS = 10;
+
+struct Edge {
+    float x0, y0, x1, y1;
+};
+
+// Set-associative LRU cache over byte addresses
+class CacheModel {
+public:
+    static constexpr int LINE_BYTES = 64;
+    static constexpr int WAYS = 8;
+    static constexpr int SETS = 32 * 1024 / LINE_BYTES / WAYS;
+
+    void access(size_t address) {
+        size_t line = address / LINE_BYTES;
+        size_t* set = &tags[(line % SETS) * WAYS];
+        accesses++;
+        for (int w = 0; w < WAYS; ++w) {
+            if (set[w] == line + 1) {
+                std::rotate(set, set + w, set + w + 1); // most recent first
+                return;
+            }
+        }
+        misses++;
+        std::rotate(set, set + WAYS - 1, set + WAYS);
+        set[0] = line + 1;
+    }
+
+    size_t accesses = 0, misses = 0;
+
+private:
+    std::vector<size_t> tags = std::vector<size_t>(static_cast<size_t>(SETS) * WAYS, 0);
+};
+
+// Best of RUNS, in nanoseconds per edge
+template <typename Fn>
+double timePerEdge(Fn&& fn) {
+    double best = 1e30;
+    for (int run = 0; run < RUNS; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ns / EDGES);
+    }
+    return best;
+}
+
+// Best of RUNS for each of two loops, timed in turn so both see the same machine state, and the
+// median over runs of the second's time over the first's: steadier than the ratio of the bests
+// when the machine is noisy
+template <typename FnA, typename FnB>
+void timePair(FnA&& a, FnB&& b, double& bestA, double& bestB, double& ratio) {
+    std::vector<double> ratios;
+    bestA = bestB = 1e30;
+    for (int run = 0; run < RUNS; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        a();
+        auto middle = std::chrono::steady_clock::now();
+        b();
+        double nsA = std::chrono::duration<double, std::nano>(middle - start).count();
+        double nsB = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - middle).count();
+        bestA = std::min(bestA, nsA / EDGES);
+        bestB = std::min(bestB, nsB / EDGES);
+        ratios.push_back(nsB / nsA);
+    }
+    std::sort(ratios.begin(), ratios.end());
+    ratio = ratios[RUNS / 2];
+}
+
+// Pixel addresses of a DDA walk over each edge, as the rasterizers visit them
+void simulate(const Framebuffer& fb, const std::vector<Edge>& edges, CacheModel& cache) {
+    for (const Edge& e : edges) {
+        float dx = e.x1 - e.x0, dy = e.y1 - e.y0;
+        int steps = static_cast<int>(std::ceil(std::max(std::fabs(dx), std::fabs(dy))));
+        for (int i = 0; i <= steps; ++i) {
+            float t = steps > 0 ? static_cast<float>(i) / steps : 0.0f;
+            int x = static_cast<int>(e.x0 + dx * t + 0.5f), y = static_cast<int>(e.y0 + dy * t + 0.5f);
+            if (x >= 0 && y >= 0 && x < fb.width() && y < fb.height()) cache.access(fb.index(x, y) * sizeof(uint32_t));
+        }
+    }
+}
+
+int main() {
+    // Random centers, orientations and lengths from 16 to 512 pixels
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Edge> edges(EDGES);
+    for (Edge& e : edges) {
+        float cx = unit(rng) * WIDTH, cy = unit(rng) * HEIGHT;
+        float angle = unit(rng) * 6.2831853f, half = 8 + unit(rng) * 248;
+        e = Edge{cx - std::cos(angle) * half, cy - std::sin(angle) * half, cx + std::cos(angle) * half, cy + std::sin(angle) * half};
+    }
+
+    std::printf("%dx%d, %d edges\n", WIDTH, HEIGHT, EDGES);
+    std::printf("%-8s %12s %12s %14s\n", "layout", "flat ns", "upload ms", "L1 miss/kpx");
+    const FramebufferLayout layouts[] = {FramebufferLayout::Linear, FramebufferLayout::Tiled};
+    for (FramebufferLayout layout : layouts) {
+        Framebuffer fb(WIDTH, HEIGHT, layout);
+        double flat = timePerEdge([&] {
+            for (const Edge& e : edges) drawLineGradient(fb, e.x0, e.y0, e.x1, e.y1, 0xFFFFFFFF, 0xFFFFFFFF);
+        });
+
+        double upload = 1e30;
+        for (int run = 0; run < RUNS; ++run) {
+            auto start = std::chrono::steady_clock::now();
+            volatile uint32_t sink = fb.linearData()[WIDTH * HEIGHT / 2];
+            (void)sink;
+            upload = std::min(upload, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        CacheModel cache;
+        simulate(fb, edges, cache);
+        std::printf("%-8s %12.1f %12.2f %14.1f\n", layout == FramebufferLayout::Tiled ? "tiled" : "linear", flat, upload,
+                    1000.0 * cache.misses / cache.accesses);
+    }
+
+    // Same edges, drawn in Morton order of their midpoints. The per-frame screen sort is timed with
+    // the drawing; the object-space sort is the static-view case, done once before the frames.
+    // Short edges are where order matters: a long edge crosses the screen whatever comes next.
+    std::vector<Edge> shortEdges(EDGES);
+    for (Edge& e : shortEdges) {
+        float cx = unit(rng) * WIDTH, cy = unit(rng) * HEIGHT;
+        float angle = unit(rng) * 6.2831853f, half = 2 + unit(rng) * 30;
+        e = Edge{cx - std::cos(angle) * half, cy - std::sin(angle) * half, cx + std::cos(angle) * half, cy + std::sin(angle) * half};
+    }
+    std::vector<Vec3> ends;
+    std::vector<std::pair<int, int>> pairs;
+    for (const Edge& e : shortEdges) {
+        pairs.emplace_back(static_cast<int>(ends.size()), static_cast<int>(ends.size()) + 1);
+        ends.push_back(Vec3{e.x0, e.y0, 0});
+        ends.push_back(Vec3{e.x1, e.y1, 0});
+    }
+
+    std::printf("\n%d edges of 4-64 pixels, flat lines\n", EDGES);
+    std::printf("%-8s %-14s %12s %12s %10s %14s\n", "layout", "order", "sort ns", "total ns", "vs given", "L1 miss/kpx");
+    FrameArena arena;
+    for (FramebufferLayout layout : layouts) {
+        Framebuffer fb(WIDTH, HEIGHT, layout);
+        for (EdgeOrdering ordering : {EdgeOrdering::AsGiven, EdgeOrdering::ScreenMorton, EdgeOrdering::ObjectMorton}) {
+            std::vector<Edge> ordered = shortEdges;
+            double sort = 0;
+            if (ordering == EdgeOrdering::ScreenMorton) {
+                sort = timePerEdge([&] {
+                    arena.reset();
+                    mortonEdgeOrder(pairs, ends.data(), arena);
+                });
+                const uint32_t* order = mortonEdgeOrder(pairs, ends.data(), arena);
+                for (int i = 0; i < EDGES; ++i) ordered[i] = shortEdges[order[i]];
+            } else if (ordering == EdgeOrdering::ObjectMorton) {
+                std::vector<std::pair<int, int>> sorted = pairs;
+                mortonSortEdges(sorted, ends);
+                for (int i = 0; i < EDGES; ++i) ordered[i] = shortEdges[sorted[i].first / 2];
+            }
+            // Each order is timed against the edges as given, in turn, so rows compare on a noisy machine
+            double given, draw, ratio;
+            timePair([&] {
+                for (const Edge& e : shortEdges) drawLineGradient(fb, e.x0, e.y0, e.x1, e.y1, 0xFFFFFFFF, 0xFFFFFFFF);
+            }, [&] {
+                for (const Edge& e : ordered) drawLineGradient(fb, e.x0, e.y0, e.x1, e.y1, 0xFFFFFFFF, 0xFFFFFFFF);
+            }, given, draw, ratio);
+
+            CacheModel cache;
+            simulate(fb, ordered, cache);
+            std::printf("%-8s %-14s %12.1f %12.1f %10.2f %14.1f\n", layout == FramebufferLayout::Tiled ? "tiled" : "linear",
+                        edgeOrderingName(ordering), sort, sort + draw, ratio + sort / given, 1000.0 * cache.misses / cache.accesses);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+// Accuracy and speed of the fastTrig.h modes against std::sin / std::cos.
+// Build with "make bench" and run sincosBench.
+#include "../fastTrig.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+constexpr size_t COUNT = 1 << 20;
+constexpr int RUNS = 20;
+
+// Best of RUNS, in nanoseconds per angle
+template <typename Fn>
+double timePerAngle(Fn&& fn) {
+    double best = 1e30;
+    for (int run = 0; run < RUNS; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ns / COUNT);
+    }
+    return best;
+}
+
+int main() {
+    // Angles over [-100, 100], about 32 turns each way
+    std::vector<float> angles(COUNT), s(COUNT), c(COUNT);
+    for (size_t i = 0; i < COUNT; ++i) angles[i] = -100.0f + 200.0f * i / COUNT;
+
+    // Reference: std::sin / std::cos one call each
+    double referenceTime = timePerAngle([&] {
+        for (size_t i = 0; i < COUNT; ++i) {
+            s[i] = std::sin(angles[i]);
+            c[i] = std::cos(angles[i]);
+        }
+    });
+    std::printf("%-10s %10s %12s %12s\n", "mode", "max error", "ns/angle", "speedup");
+    std::printf("%-10s %10s %12.2f %12s\n", "std", "-", referenceTime, "1.00x");
+
+    struct Mode {
+        const char* name;
+        TrigAccuracy accuracy;
+    };
+    const Mode modes[] = {{"Fast", TrigAccuracy::Fast}, {"Precise", TrigAccuracy::Precise}, {"Full", TrigAccuracy::Full}};
+    for (const Mode& mode : modes) {
+        double arrayTime = timePerAngle([&] { sinCos(angles.data(), s.data(), c.data(), COUNT, mode.accuracy); });
+
+        double maxError = 0;
+        for (size_t i = 0; i < COUNT; ++i) {
+            double x = angles[i];
+            maxError = std::max(maxError, std::fabs(s[i] - std::sin(x)));
+            maxError = std::max(maxError, std::fabs(c[i] - std::cos(x)));
+        }
+
+        double scalarTime = timePerAngle([&] {
+            for (size_t i = 0; i < COUNT; ++i) sinCos(angles[i], s[i], c[i], mode.accuracy);
+        });
+        double laneTime = timePerAngle([&] {
+            for (size_t i = 0; i < COUNT; i += TRIG_LANES) sinCos8(&angles[i], &s[i], &c[i], mode.accuracy);
+        });
+
+        std::printf("%-10s %10.2e %12.2f %11.2fx   (scalar %.2f ns, 8-wide %.2f ns)\n", mode.name, maxError, arrayTime,
+                    referenceTime / arrayTime, scalarTime, laneTime);
+    }
+    return 0;
+}
@@ -0,0 +1,398 @@
+#pragma once
+#include "vec.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+// Axis-aligned bounding box, empty by default
+struct AABB {
+    Vec3 min{FLT_MAX, FLT_MAX, FLT_MAX};
+    Vec3 max{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+
+    void grow(const Vec3& p) { min = minVec(min, p); max = maxVec(max, p); }
+    void grow(const AABB& b) { min = minVec(min, b.min); max = maxVec(max, b.max); }
+
+    Vec3 center() const { return (min + max) * 0.5f; }
+
+    float surfaceArea() const {
+        if (min.x > max.x) return 0;
+        Vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    bool overlaps(const AABB& b) const {
+        return min.x <= b.max.x && max.x >= b.min.x &&
+               min.y <= b.max.y && max.y >= b.min.y &&
+               min.z <= b.max.z && max.z >= b.min.z;
+    }
+
+    bool operator==(const AABB& b) const {
+        return min.x == b.min.x && min.y == b.min.y && min.z == b.min.z &&
+               max.x == b.max.x && max.y == b.max.y && max.z == b.max.z;
+    }
+};
+
+// Plane as dot(normal, p) + d, positive on the inside
+struct Plane {
+    Vec3 normal;
+    float d;
+};
+
+struct Frustum {
+    Plane planes[6];
+
+    // View-space frustum for a camera at the origin looking down +z, x right and y up (Camera3D's
+    // convention, before its zOffset push). tanHalfX/tanHalfY are the half extents of the view at unit depth.
+    static Frustum perspective(float tanHalfX, float tanHalfY, float near, float far) {
+        Frustum f;
+        f.planes[0] = Plane{Vec3{-1, 0, tanHalfX}, 0};
+        f.planes[1] = Plane{Vec3{ 1, 0, tanHalfX}, 0};
+        f.planes[2] = Plane{Vec3{0, -1, tanHalfY}, 0};
+        f.planes[3] = Plane{Vec3{0,  1, tanHalfY}, 0};
+        f.planes[4] = Plane{Vec3{0, 0,  1}, -near};
+        f.planes[5] = Plane{Vec3{0, 0, -1}, far};
+        return f;
+    }
+};
+
+struct Ray {
+    Vec3 origin;
+    Vec3 dir;
+    Vec3 invDir;
+
+    Ray(const Vec3& o, const Vec3& d) : origin(o), dir(d), invDir{1.0f / d.x, 1.0f / d.y, 1.0f / d.z} {}
+
+    // Slab test, returns the entry distance or a negative value on a miss
+    float intersect(const AABB& b, float tMax) const {
+        float tx1 = (b.min.x - origin.x) * invDir.x, tx2 = (b.max.x - origin.x) * invDir.x;
+        float ty1 = (b.min.y - origin.y) * invDir.y, ty2 = (b.max.y - origin.y) * invDir.y;
+        float tz1 = (b.min.z - origin.z) * invDir.z, tz2 = (b.max.z - origin.z) * invDir.z;
+        float tNear = std::max({std::min(tx1, tx2), std::min(ty1, ty2), std::min(tz1, tz2), 0.0f});
+        float tFar = std::min({std::max(tx1, tx2), std::max(ty1, ty2), std::max(tz1, tz2), tMax});
+        return tNear <= tFar ? tNear : -1.0f;
+    }
+};
+
+// Bounding volume hierarchy over scene objects, built with binned SAH.
+// Objects are identified by their index in the bounds array passed to build().
+class Bvh {
+public:
+    static constexpr int BIN_COUNT = 16;
+    static constexpr int MAX_LEAF_SIZE = 4;
+    static constexpr int MAX_DEPTH = 60;       // keeps the fixed traversal stack below safe
+    static constexpr int MIN_TASK_SIZE = 1024; // subtrees smaller than this are not worth a thread
+
+    void build(const std::vector<AABB>& bounds, int threadCount = 0) {
+        objectBounds = bounds;
+        int objectCount = static_cast<int>(bounds.size());
+
+        nodes.clear();
+        objectIndices.resize(objectCount);
+        leafOfObject.assign(objectCount, -1);
+        centroids.resize(objectCount);
+        dirtyLeaves.clear();
+        for (int i = 0; i < objectCount; ++i) {
+            objectIndices[i] = i;
+            centroids[i] = bounds[i].center();
+        }
+        if (objectCount == 0) return;
+
+        if (threadCount <= 0) threadCount = workerCount();
+
+        // Split the top of the tree on this thread, then build the remaining subtrees in parallel
+        std::vector<Task> tasks;
+        int taskSize = std::max(MIN_TASK_SIZE, objectCount / (threadCount * 4));
+        nodes.push_back(Node{AABB{}, 0, 0, -1});
+        buildNode(nodes, 0, 0, objectCount, 0, threadCount > 1 ? taskSize : 0, &tasks);
+
+        std::vector<std::vector<Node>> subtrees(tasks.size());
+        parallelFor(static_cast<int>(tasks.size()), [&](int i) {
+            subtrees[i].push_back(Node{AABB{}, 0, 0, -1});
+            buildNode(subtrees[i], 0, tasks[i].first, tasks[i].count, tasks[i].depth, 0, nullptr);
+        }, threadCount);
+
+        for (size_t i = 0; i < tasks.size(); ++i) splice(tasks[i].node, subtrees[i]);
+
+        for (int n = 0; n < static_cast<int>(nodes.size()); ++n) {
+            for (int k = 0; k < nodes[n].count; ++k) leafOfObject[objectIndices[nodes[n].first + k]] = n;
+        }
+        centroids.clear();
+    }
+
+    // Record new bounds for a moved object; the tree is fixed up by the next refit()
+    void update(int object, const AABB& bounds) {
+        objectBounds[object] = bounds;
+        dirtyLeaves.push_back(leafOfObject[object]);
+    }
+
+    // Grow/shrink the bounds on the path from each touched leaf to the root.
+    // Cost is proportional to the number of moved objects, not the scene size.
+    void refit() {
+        for (int leaf : dirtyLeaves) {
+            AABB b;
+            for (int k = 0; k < nodes[leaf].count; ++k) b.grow(objectBounds[objectIndices[nodes[leaf].first + k]]);
+            if (b == nodes[leaf].bounds) continue;
+            nodes[leaf].bounds = b;
+
+            for (int n = nodes[leaf].parent; n >= 0; n = nodes[n].parent) {
+                AABB merged = nodes[nodes[n].first].bounds;
+                merged.grow(nodes[nodes[n].first + 1].bounds);
+                if (merged == nodes[n].bounds) break; // ancestors are already correct
+                nodes[n].bounds = merged;
+            }
+        }
+        dirtyLeaves.clear();
+    }
+
+    // Call visible(object) for every object whose bounds are not fully outside the frustum
+    template <typename Fn>
+    void cullFrustum(const Frustum& frustum, Fn&& visible) const {
+        if (nodes.empty()) return;
+
+        // Entries are node * 2 + 1 when the node is already known to be fully inside
+        int stack[MAX_DEPTH + 4];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            int entry = stack[--top];
+            const Node& node = nodes[entry >> 1];
+            bool inside = (entry & 1) != 0;
+
+            if (!inside) {
+                int result = classify(frustum, node.bounds);
+                if (result < 0) continue;
+                inside = result > 0;
+            }
+
+            if (node.count > 0) {
+                for (int k = 0; k < node.count; ++k) {
+                    int object = objectIndices[node.first + k];
+                    if (inside || classify(frustum, objectBounds[object]) >= 0) visible(object);
+                }
+            } else {
+                stack[top++] = node.first * 2 + inside;
+                stack[top++] = (node.first + 1) * 2 + inside;
+            }
+        }
+    }
+
+    // Call found(object) for every object whose bounds overlap the box
+    template <typename Fn>
+    void queryRange(const AABB& range, Fn&& found) const {
+        if (nodes.empty()) return;
+
+        int stack[MAX_DEPTH + 4];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (!node.bounds.overlaps(range)) continue;
+
+            if (node.count > 0) {
+                for (int k = 0; k < node.count; ++k) {
+                    int object = objectIndices[node.first + k];
+                    if (objectBounds[object].overlaps(range)) found(object);
+                }
+            } else {
+                stack[top++] = node.first;
+                stack[top++] = node.first + 1;
+            }
+        }
+    }
+
+    // Nearest object hit by the ray (e.g. a mouse pick), or -1.
+    // hitTest(object, tMax) returns the exact hit distance or a negative value on a miss.
+    template <typename Fn>
+    int pick(const Ray& ray, Fn&& hitTest, float& hitT) const {
+        int hitObject = -1;
+        hitT = FLT_MAX;
+        if (nodes.empty() || ray.intersect(nodes[0].bounds, hitT) < 0) return -1;
+
+        int stack[MAX_DEPTH + 4];
+        int top = 0;
+        stack[top++] = 0;
+
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (ray.intersect(node.bounds, hitT) < 0) continue; // hitT may have shrunk since the push
+
+            if (node.count > 0) {
+                for (int k = 0; k < node.count; ++k) {
+                    int object = objectIndices[node.first + k];
+                    if (ray.intersect(objectBounds[object], hitT) < 0) continue;
+                    float t = hitTest(object, hitT);
+                    if (t >= 0 && t < hitT) {
+                        hitT = t;
+                        hitObject = object;
+                    }
+                }
+            } else {
+                // Visit the nearer child first so the farther one is more likely to be pruned
+                int a = node.first, b = node.first + 1;
+                float ta = ray.intersect(nodes[a].bounds, hitT);
+                float tb = ray.intersect(nodes[b].bounds, hitT);
+                if (ta >= 0 && tb >= 0) {
+                    if (tb < ta) std::swap(a, b);
+                    stack[top++] = b;
+                    stack[top++] = a;
+                } else if (ta >= 0) {
+                    stack[top++] = a;
+                } else if (tb >= 0) {
+                    stack[top++] = b;
+                }
+            }
+        }
+        return hitObject;
+    }
+
+    // Pick against the object bounds themselves
+    int pick(const Ray& ray, float& hitT) const {
+        return pick(ray, [&](int object, float tMax) { return ray.intersect(objectBounds[object], tMax); }, hitT);
+    }
+
+    const AABB& bounds() const { return nodes.front().bounds; }
+    bool empty() const { return nodes.empty(); }
+
+private:
+    // Leaves have count > 0 and own objectIndices[first, first + count).
+    // Interior nodes have count == 0 and children at first and first + 1.
+    struct Node {
+        AABB bounds;
+        int first;
+        int count;
+        int parent;
+    };
+
+    // A subtree deferred to a worker thread
+    struct Task {
+        int node, first, count, depth;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<int> objectIndices;
+    std::vector<int> leafOfObject;
+    std::vector<AABB> objectBounds;
+    std::vector<Vec3> centroids;
+    std::vector<int> dirtyLeaves;
+
+    static float axis(const Vec3& v, int a) { return a == 0 ? v.x : (a == 1 ? v.y : v.z); }
+
+    // -1 fully outside, 0 intersecting, 1 fully inside
+    static int classify(const Frustum& frustum, const AABB& b) {
+        int result = 1;
+        for (const Plane& p : frustum.planes) {
+            Vec3 far{p.normal.x > 0 ? b.max.x : b.min.x, p.normal.y > 0 ? b.max.y : b.min.y, p.normal.z > 0 ? b.max.z : b.min.z};
+            Vec3 near{p.normal.x > 0 ? b.min.x : b.max.x, p.normal.y > 0 ? b.min.y : b.max.y, p.normal.z > 0 ? b.min.z : b.max.z};
+            if (dot(p.normal, far) + p.d < 0) return -1;
+            if (dot(p.normal, near) + p.d < 0) result = 0;
+        }
+        return result;
+    }
+
+    int binOf(int object, int a, float lo, float scale) const {
+        int bin = static_cast<int>((axis(centroids[object], a) - lo) * scale);
+        return std::min(std::max(bin, 0), BIN_COUNT - 1);
+    }
+
+    // Build the subtree rooted at out[nodeIndex] over objectIndices[first, first + count).
+    // Ranges of at most taskSize objects are pushed to tasks instead of being built here.
+    void buildNode(std::vector<Node>& out, int nodeIndex, int first, int count, int depth, int taskSize, std::vector<Task>* tasks) {
+        AABB b, centroidBounds;
+        for (int i = first; i < first + count; ++i) {
+            b.grow(objectBounds[objectIndices[i]]);
+            centroidBounds.grow(centroids[objectIndices[i]]);
+        }
+        out[nodeIndex].bounds = b;
+
+        if (count <= MAX_LEAF_SIZE || depth >= MAX_DEPTH) {
+            out[nodeIndex].first = first;
+            out[nodeIndex].count = count;
+            return;
+        }
+        if (tasks && count <= taskSize) {
+            tasks->push_back(Task{nodeIndex, first, count, depth});
+            return;
+        }
+
+        // Binned SAH over all three axes
+        float bestCost = FLT_MAX;
+        int bestAxis = -1, bestSplit = 0;
+        for (int a = 0; a < 3; ++a) {
+            float lo = axis(centroidBounds.min, a);
+            float extent = axis(centroidBounds.max, a) - lo;
+            if (extent <= 0) continue;
+            float scale = BIN_COUNT / extent;
+
+            AABB binBounds[BIN_COUNT];
+            int binCount[BIN_COUNT] = {};
+            for (int i = first; i < first + count; ++i) {
+                int bin = binOf(objectIndices[i], a, lo, scale);
+                binCount[bin]++;
+                binBounds[bin].grow(objectBounds[objectIndices[i]]);
+            }
+
+            // Sweep from the right to get the cost of everything above each split plane
+            float rightArea[BIN_COUNT];
+            int rightCount[BIN_COUNT];
+            AABB acc;
+            int n = 0;
+            for (int i = BIN_COUNT - 1; i > 0; --i) {
+                acc.grow(binBounds[i]);
+                n += binCount[i];
+                rightArea[i] = acc.surfaceArea();
+                rightCount[i] = n;
+            }
+
+            acc = AABB{};
+            n = 0;
+            for (int i = 0; i < BIN_COUNT - 1; ++i) {
+                acc.grow(binBounds[i]);
+                n += binCount[i];
+                if (n == 0 || rightCount[i + 1] == 0) continue;
+                float cost = n * acc.surfaceArea() + rightCount[i + 1] * rightArea[i + 1];
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = a;
+                    bestSplit = i;
+                }
+            }
+        }
+
+        int mid = first + count / 2;
+        if (bestAxis >= 0) {
+            float lo = axis(centroidBounds.min, bestAxis);
+            float scale = BIN_COUNT / (axis(centroidBounds.max, bestAxis) - lo);
+            auto it = std::partition(objectIndices.begin() + first, objectIndices.begin() + first + count,
+                [&](int object) { return binOf(object, bestAxis, lo, scale) <= bestSplit; });
+            mid = static_cast<int>(it - objectIndices.begin());
+        }
+        // All centroids coincide: fall back to splitting the range in half so leaves stay small
+
+        int left = static_cast<int>(out.size());
+        out.push_back(Node{AABB{}, 0, 0, nodeIndex});
+        out.push_back(Node{AABB{}, 0, 0, nodeIndex});
+        out[nodeIndex].first = left;
+        out[nodeIndex].count = 0;
+
+        buildNode(out, left, first, mid - first, depth + 1, taskSize, tasks);
+        buildNode(out, left + 1, mid, first + count - mid, depth + 1, taskSize, tasks);
+    }
+
+    // Move a subtree built by a worker into the shared node array, replacing the placeholder at nodeIndex
+    void splice(int nodeIndex, const std::vector<Node>& subtree) {
+        int base = static_cast<int>(nodes.size()) - 1;
+        auto global = [&](int local) { return local == 0 ? nodeIndex : base + local; };
+
+        int parent = nodes[nodeIndex].parent;
+        nodes.resize(base + subtree.size());
+        for (int local = 0; local < static_cast<int>(subtree.size()); ++local) {
+            Node node = subtree[local];
+            node.parent = local == 0 ? parent : global(node.parent);
+            if (node.count == 0) node.first = global(node.first);
+            nodes[global(local)] = node;
+        }
+    }
+};
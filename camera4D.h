@@ -0,0 +1,102 @@
+#pragma once
+#include "fastTrig.h"
+#include "quaternion.h"
+#include "vec.h"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// 4D vertices in structure-of-arrays form, the input layout of the projection passes
+struct Vec4Soa {
+    std::vector<float> x, y, z, w;
+
+    size_t size() const { return x.size(); }
+
+    void push_back(const Vec4& v) {
+        x.push_back(v.x);
+        y.push_back(v.y);
+        z.push_back(v.z);
+        w.push_back(v.w);
+    }
+};
+
+// Rotation in the plane of one of x/y/z (axis 0/1/2) and w; axis < 0 means no rotation
+struct Rotation4D {
+    int axis = -1;
+    float angle = 0;
+};
+
+// Camera on the w axis at wDistance, looking toward w = 0: a 4D point is scaled by
+// wDistance / (wDistance - w), the way a 3D camera divides by z.
+// wDistance <= 0 drops w instead (orthographic).
+struct Camera4D {
+    float wDistance = 3.0f;
+};
+
+// 3D camera at the origin looking down +z: points are pushed back by zOffset (z' = z + zOffset),
+// then projected into a viewport with y pointing down:
+// (x * focalX / z' + centerX, centerY - y * focalY / z', 1 / z')
+struct Camera3D {
+    float zOffset = 0;
+    float focalX = 1, focalY = 1; // pixels per unit at z = 1
+    float centerX = 0, centerY = 0;
+
+    static Camera3D perspective(float fovDegrees, float scale, float zOffset, int viewportWidth, int viewportHeight) {
+        float tanHalfFov = std::tan(fovDegrees * static_cast<float>(M_PI) / 360.0f);
+        float aspect = static_cast<float>(viewportWidth) / viewportHeight;
+        Camera3D camera;
+        camera.zOffset = zOffset;
+        camera.focalX = scale / tanHalfFov;
+        camera.focalY = scale / (tanHalfFov * aspect);
+        camera.centerX = viewportWidth / 2.0f;
+        camera.centerY = viewportHeight / 2.0f;
+        return camera;
+    }
+
+    // Screen x, y and 1/z of a world-space point; points at or behind the camera get 1/z = 0
+    Vec3 project(float x, float y, float z) const {
+        z += zOffset;
+        float invZ = z > 0 ? 1.0f / z : 0.0f;
+        return Vec3{centerX + x * focalX * invZ, centerY - y * focalY * invZ, invZ};
+    }
+};
+
+// Camera stage only, for world positions that are already known (e.g. from a TransformCache)
+inline void projectPoints(const Vec3* world, size_t count, const Camera3D& camera, Vec3* screen) {
+    for (size_t i = 0; i < count; ++i) screen[i] = camera.project(world[i].x, world[i].y, world[i].z);
+}
+
+// The 4D pipeline (4D plane rotation, 4D -> 3D perspective, 3D rotation, 3D -> 2D projection)
+// runs in two passes. The first, rotatePoints3D, is the 3D rotation of x, y, z alone: it does not
+// depend on the 4D rotation or camera, so every viewport showing the mesh with the same 3D
+// rotation can share it through a TransformCache.
+inline void rotatePoints3D(const Vec4Soa& in, const Mat3& rotation3D, Vec3* rotated) {
+    const float* xs = in.x.data();
+    const float* ys = in.y.data();
+    const float* zs = in.z.data();
+    for (size_t i = 0, count = in.size(); i < count; ++i) rotated[i] = rotation3D * Vec3{xs[i], ys[i], zs[i]};
+}
+
+// Second pass, per viewport: the rest of the pipeline for points from rotatePoints3D. The plane
+// rotation only changes one of x/y/z (v becomes c * v - s * w), and the 3D rotation is linear, so
+// it lands on the rotated point as that change times the axis's column of rotation3D. Then one
+// divide by the w depth and one by the z depth; screen receives x, y, 1/z.
+inline void project4D(const Vec4Soa& in, const Vec3* rotated, const Rotation4D& rotation4D, const Camera4D& camera4D,
+                      const Mat3& rotation3D, const Camera3D& camera3D, Vec3* screen) {
+    // No rotation is the plane rotation by 0 about any axis
+    int a = rotation4D.axis >= 0 ? rotation4D.axis : 0;
+    float s = 0, c = 1;
+    if (rotation4D.axis >= 0) sinCos(rotation4D.angle, s, c);
+    Vec3 column{rotation3D.m[0][a], rotation3D.m[1][a], rotation3D.m[2][a]};
+    bool perspective = camera4D.wDistance > 0;
+    float d = camera4D.wDistance;
+
+    const float* vs = a == 0 ? in.x.data() : a == 1 ? in.y.data() : in.z.data();
+    const float* ws = in.w.data();
+    for (size_t i = 0, count = in.size(); i < count; ++i) {
+        float v = vs[i], w = ws[i];
+        float scale = perspective ? d / (d - (s * v + c * w)) : 1.0f;
+        Vec3 p = (rotated[i] + column * ((c - 1) * v - s * w)) * scale;
+        screen[i] = camera3D.project(p.x, p.y, p.z);
+    }
+}
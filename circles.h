@@ -0,0 +1,226 @@
+#pragma once
+#include "framebuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Midpoint circle, ellipse and arc rasterizers.
+// Each walks one octant (circles) or quadrant (ellipses) with integer decision variables and
+// mirrors it, so there is no trig and no square root per pixel. The generic versions hand out
+// pixels through plot(x, y) or spans through span(y, x0, x1), which lets the same code feed the
+// framebuffer or an SDL point list; the Framebuffer overloads below clip and write colors.
+
+// The eight mirror images of (x, y) about (cx, cy), each pixel once
+template <typename Plot>
+inline void plotOctants(int cx, int cy, int x, int y, Plot&& plot) {
+    auto plot4 = [&](int u, int v) {
+        plot(cx + u, cy + v);
+        if (u != 0) plot(cx - u, cy + v);
+        if (v != 0) plot(cx + u, cy - v);
+        if (u != 0 && v != 0) plot(cx - u, cy - v);
+    };
+    plot4(x, y);
+    if (x != y) plot4(y, x);
+}
+
+// Circle outline of integer radius r
+template <typename Plot>
+inline void rasterCircle(int cx, int cy, int r, Plot&& plot) {
+    if (r < 0) return;
+    int x = 0, y = r, d = 1 - r;
+    while (x <= y) {
+        plotOctants(cx, cy, x, y, plot);
+        if (d < 0) {
+            d += 2 * x + 3;
+        } else {
+            d += 2 * (x - y) + 5;
+            y--;
+        }
+        x++;
+    }
+}
+
+// Filled circle as horizontal spans, each row emitted once
+template <typename Span>
+inline void rasterFilledCircle(int cx, int cy, int r, Span&& span) {
+    if (r < 0) return;
+    int x = 0, y = r, d = 1 - r;
+    while (x <= y) {
+        // Rows cy +- x take half-width y; rows cy +- y only once y is about to change
+        span(cy + x, cx - y, cx + y);
+        if (x != 0) span(cy - x, cx - y, cx + y);
+        if (d < 0) {
+            d += 2 * x + 3;
+        } else {
+            if (x != y) {
+                span(cy + y, cx - x, cx + x);
+                span(cy - y, cx - x, cx + x);
+            }
+            d += 2 * (x - y) + 5;
+            y--;
+        }
+        x++;
+    }
+}
+
+// Walks the first quadrant of an ellipse from (0, ry) to (rx, 0): step(x, y) gets every outline
+// point in order, x never decreasing and y never increasing
+template <typename Step>
+inline void walkEllipse(int rx, int ry, Step&& step) {
+    if (ry == 0) {
+        for (int x = 0; x <= rx; ++x) step(x, 0);
+        return;
+    }
+    int64_t rx2 = static_cast<int64_t>(rx) * rx, ry2 = static_cast<int64_t>(ry) * ry;
+    int64_t x = 0, y = ry;
+    int64_t px = 0, py = 2 * rx2 * y;
+
+    // Region 1: slope shallower than -1, x advances every step
+    int64_t p = ry2 - rx2 * ry + rx2 / 4;
+    while (px < py) {
+        step(static_cast<int>(x), static_cast<int>(y));
+        x++;
+        px += 2 * ry2;
+        if (p < 0) {
+            p += ry2 + px;
+        } else {
+            y--;
+            py -= 2 * rx2;
+            p += ry2 + px - py;
+        }
+    }
+
+    // Region 2: y advances every step
+    p = ry2 * (x * x + x) + ry2 / 4 + rx2 * (y - 1) * (y - 1) - rx2 * ry2;
+    while (y >= 0) {
+        step(static_cast<int>(x), static_cast<int>(y));
+        y--;
+        py -= 2 * rx2;
+        if (p > 0) {
+            p += rx2 - py;
+        } else {
+            x++;
+            px += 2 * ry2;
+            p += rx2 - py + px;
+        }
+    }
+}
+
+// Axis-aligned ellipse outline with radii rx, ry (4-way symmetry, an ellipse has no more)
+template <typename Plot>
+inline void rasterEllipse(int cx, int cy, int rx, int ry, Plot&& plot) {
+    if (rx < 0 || ry < 0) return;
+    walkEllipse(rx, ry, [&](int x, int y) {
+        plot(cx + x, cy + y);
+        if (x != 0) plot(cx - x, cy + y);
+        if (y != 0) plot(cx + x, cy - y);
+        if (x != 0 && y != 0) plot(cx - x, cy - y);
+    });
+}
+
+// Filled ellipse as horizontal spans, each row emitted once with its widest extent
+template <typename Span>
+inline void rasterFilledEllipse(int cx, int cy, int rx, int ry, Span&& span) {
+    if (rx < 0 || ry < 0) return;
+    int rowY = ry, rowX = 0;
+    auto emit = [&]() {
+        span(cy + rowY, cx - rowX, cx + rowX);
+        if (rowY != 0) span(cy - rowY, cx - rowX, cx + rowX);
+    };
+    walkEllipse(rx, ry, [&](int x, int y) {
+        if (y != rowY) emit();
+        rowY = y;
+        rowX = x;
+    });
+    emit();
+}
+
+// Circle arc from startAngle sweeping by sweepAngle radians (positive turns from +x toward +y,
+// which is clockwise on screen). The sector test is two cross products per pixel.
+template <typename Plot>
+inline void rasterArc(int cx, int cy, int r, float startAngle, float sweepAngle, Plot&& plot) {
+    if (sweepAngle < 0) {
+        startAngle += sweepAngle;
+        sweepAngle = -sweepAngle;
+    }
+    if (sweepAngle >= 2.0f * static_cast<float>(M_PI)) {
+        rasterCircle(cx, cy, r, plot);
+        return;
+    }
+    float sx = std::cos(startAngle), sy = std::sin(startAngle);
+    float ex = std::cos(startAngle + sweepAngle), ey = std::sin(startAngle + sweepAngle);
+    bool wide = sweepAngle > static_cast<float>(M_PI);
+
+    rasterCircle(cx, cy, r, [&](int px, int py) {
+        float x = static_cast<float>(px - cx), y = static_cast<float>(py - cy);
+        bool afterStart = sx * y - sy * x >= 0;
+        bool beforeEnd = x * ey - y * ex >= 0;
+        if (wide ? (afterStart || beforeEnd) : (afterStart && beforeEnd)) plot(px, py);
+    });
+}
+
+// Anti-aliased circle outline (Wu): two pixels per column, weighted by how far the true curve
+// sits between them. plot(x, y, coverage) gets coverage 0..255. One square root per column;
+// the center snaps to the nearest pixel so the eight octants stay exact mirrors.
+template <typename Plot>
+inline void rasterCircleAA(float cx, float cy, float r, Plot&& plot) {
+    if (r <= 0) return;
+    int icx = static_cast<int>(std::lround(cx)), icy = static_cast<int>(std::lround(cy));
+    float r2 = r * r;
+    auto plot8 = [&](int x, int y, int coverage) {
+        if (coverage <= 0) return;
+        plotOctants(icx, icy, x, y, [&](int px, int py) { plot(px, py, coverage); });
+    };
+
+    for (int x = 0;; ++x) {
+        float yf = std::sqrt(std::max(r2 - static_cast<float>(x) * x, 0.0f));
+        if (x > yf) break;
+        int y = static_cast<int>(yf);
+        int coverage = static_cast<int>((yf - y) * 255.0f + 0.5f);
+        plot8(x, y, 255 - coverage);
+        if (y + 1 > x) plot8(x, y + 1, coverage);
+    }
+}
+
+// Framebuffer versions: clipped to the viewport, opaque colors unless noted
+
+inline void drawCircle(Framebuffer& fb, int cx, int cy, int r, uint32_t color) {
+    int w = fb.width(), h = fb.height();
+    if (cx + r < 0 || cy + r < 0 || cx - r >= w || cy - r >= h) return;
+    rasterCircle(cx, cy, r, [&](int x, int y) {
+        if (x >= 0 && y >= 0 && x < w && y < h) fb.put(x, y, color);
+    });
+}
+
+inline void fillCircle(Framebuffer& fb, int cx, int cy, int r, uint32_t color) {
+    rasterFilledCircle(cx, cy, r, [&](int y, int x0, int x1) { fb.fillSpan(y, x0, x1, color); });
+}
+
+inline void drawEllipse(Framebuffer& fb, int cx, int cy, int rx, int ry, uint32_t color) {
+    int w = fb.width(), h = fb.height();
+    if (cx + rx < 0 || cy + ry < 0 || cx - rx >= w || cy - ry >= h) return;
+    rasterEllipse(cx, cy, rx, ry, [&](int x, int y) {
+        if (x >= 0 && y >= 0 && x < w && y < h) fb.put(x, y, color);
+    });
+}
+
+inline void fillEllipse(Framebuffer& fb, int cx, int cy, int rx, int ry, uint32_t color) {
+    rasterFilledEllipse(cx, cy, rx, ry, [&](int y, int x0, int x1) { fb.fillSpan(y, x0, x1, color); });
+}
+
+inline void drawArc(Framebuffer& fb, int cx, int cy, int r, float startAngle, float sweepAngle, uint32_t color) {
+    int w = fb.width(), h = fb.height();
+    rasterArc(cx, cy, r, startAngle, sweepAngle, [&](int x, int y) {
+        if (x >= 0 && y >= 0 && x < w && y < h) fb.put(x, y, color);
+    });
+}
+
+// Blended over what is already in the framebuffer, scaled by the color's own alpha
+inline void drawCircleAA(Framebuffer& fb, float cx, float cy, float r, uint32_t color) {
+    int w = fb.width(), h = fb.height();
+    if (cx + r < -1 || cy + r < -1 || cx - r > w || cy - r > h) return;
+    int alpha = static_cast<int>(color >> 24);
+    rasterCircleAA(cx, cy, r, [&](int x, int y, int coverage) {
+        if (x >= 0 && y >= 0 && x < w && y < h) fb.blend(x, y, color, coverage * alpha / 255);
+    });
+}
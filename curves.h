@@ -0,0 +1,177 @@
+#pragma once
+#include "vec.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+// Curves as line segments, for consumers that need polylines (SDL line batches, export).
+// Segment counts come from an on-screen error tolerance instead of a fixed number: the largest
+// distance between a segment and the true curve stays under tolerance pixels, so small curves
+// get few segments and large ones get enough to look round.
+constexpr float CURVE_TOLERANCE = 0.25f;
+constexpr int MIN_CIRCLE_SEGMENTS = 8;
+constexpr int UNIT_CIRCLE_SEGMENTS = 1024; // resolution of the shared table, a power of two
+constexpr int MAX_BEZIER_SEGMENTS = 1024;
+
+// UNIT_CIRCLE_SEGMENTS + 1 points around the unit circle (the last repeats the first), built on
+// first use. Circles and arcs read it with a stride, so they never call sin/cos per segment.
+inline const std::vector<Vec2>& unitCircle() {
+    static const std::vector<Vec2> table = [] {
+        std::vector<Vec2> points(UNIT_CIRCLE_SEGMENTS + 1);
+        for (int i = 0; i < UNIT_CIRCLE_SEGMENTS; ++i) {
+            double angle = 2.0 * M_PI * i / UNIT_CIRCLE_SEGMENTS;
+            points[i] = Vec2{static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle))};
+        }
+        points[UNIT_CIRCLE_SEGMENTS] = points[0];
+        return points;
+    }();
+    return table;
+}
+
+// Segments for a full circle: a chord over angle 2*pi/n strays r * (1 - cos(pi/n)) from the arc.
+// Rounded up to a power of two so it divides the table, which also quantizes the radius:
+// every radius in the same power-of-two band gets the same count.
+inline int circleSegments(float radius, float tolerance = CURVE_TOLERANCE) {
+    if (radius <= tolerance) return MIN_CIRCLE_SEGMENTS;
+    float exact = static_cast<float>(M_PI) / std::acos(1.0f - tolerance / radius);
+    int n = MIN_CIRCLE_SEGMENTS;
+    while (n < exact && n < UNIT_CIRCLE_SEGMENTS) n *= 2;
+    return n;
+}
+
+// Closed polyline around center: circleSegments(radius) + 1 points
+inline void tessellateCircle(const Vec2& center, float radius, std::vector<Vec2>& out, float tolerance = CURVE_TOLERANCE) {
+    const std::vector<Vec2>& table = unitCircle();
+    int n = circleSegments(radius, tolerance);
+    int stride = UNIT_CIRCLE_SEGMENTS / n;
+    out.resize(n + 1);
+    for (int i = 0; i <= n; ++i) out[i] = center + table[i * stride] * radius;
+}
+
+// Arc from startAngle sweeping by sweepAngle radians (positive toward +y). Interior points come
+// from the table at the circle's segment spacing; only the two end points need sin/cos.
+inline void tessellateArc(const Vec2& center, float radius, float startAngle, float sweepAngle, std::vector<Vec2>& out,
+                          float tolerance = CURVE_TOLERANCE) {
+    if (sweepAngle < 0) {
+        startAngle += sweepAngle;
+        sweepAngle = -sweepAngle;
+    }
+    sweepAngle = std::min(sweepAngle, 2.0f * static_cast<float>(M_PI));
+
+    const std::vector<Vec2>& table = unitCircle();
+    int n = circleSegments(radius, tolerance);
+    int stride = UNIT_CIRCLE_SEGMENTS / n;
+    float segmentsPerRadian = n / (2.0f * static_cast<float>(M_PI));
+
+    out.clear();
+    out.push_back(center + Vec2{std::cos(startAngle), std::sin(startAngle)} * radius);
+    // Table points strictly between the ends, wrapping around the table
+    int first = static_cast<int>(std::floor(startAngle * segmentsPerRadian)) + 1;
+    int last = static_cast<int>(std::ceil((startAngle + sweepAngle) * segmentsPerRadian)) - 1;
+    for (int k = first; k <= last; ++k) {
+        int i = ((k % n) + n) % n;
+        out.push_back(center + table[i * stride] * radius);
+    }
+    out.push_back(center + Vec2{std::cos(startAngle + sweepAngle), std::sin(startAngle + sweepAngle)} * radius);
+}
+
+// Segments for a Bezier curve of the given degree (Wang's bound): with M the largest second
+// difference of the control points, n = sqrt(degree * (degree - 1) * M / (8 * tolerance))
+inline int bezierSegments(const Vec2* control, int degree, float tolerance = CURVE_TOLERANCE) {
+    float m = 0;
+    for (int i = 0; i + 2 <= degree; ++i) {
+        Vec2 d = control[i + 2] - control[i + 1] * 2.0f + control[i];
+        m = std::max(m, std::sqrt(d.x * d.x + d.y * d.y));
+    }
+    float n = std::sqrt(degree * (degree - 1) * m / (8.0f * tolerance));
+    return std::min(std::max(static_cast<int>(std::ceil(n)), 1), MAX_BEZIER_SEGMENTS);
+}
+
+// Quadratic Bezier p0 -> p2 with control point p1, evaluated by forward differencing
+inline void tessellateQuadratic(const Vec2& p0, const Vec2& p1, const Vec2& p2, std::vector<Vec2>& out,
+                                float tolerance = CURVE_TOLERANCE) {
+    Vec2 control[3] = {p0, p1, p2};
+    int n = bezierSegments(control, 2, tolerance);
+    float h = 1.0f / n;
+
+    // B(t) = a t^2 + b t + p0
+    Vec2 a = p0 - p1 * 2.0f + p2;
+    Vec2 b = (p1 - p0) * 2.0f;
+    Vec2 point = p0;
+    Vec2 d1 = a * (h * h) + b * h;
+    Vec2 d2 = a * (2.0f * h * h);
+
+    out.resize(n + 1);
+    out[0] = p0;
+    for (int i = 1; i < n; ++i) {
+        point = point + d1;
+        d1 = d1 + d2;
+        out[i] = point;
+    }
+    out[n] = p2; // exact end point, no accumulated drift
+}
+
+// Cubic Bezier p0 -> p3 with control points p1, p2, evaluated by forward differencing
+inline void tessellateCubic(const Vec2& p0, const Vec2& p1, const Vec2& p2, const Vec2& p3, std::vector<Vec2>& out,
+                            float tolerance = CURVE_TOLERANCE) {
+    Vec2 control[4] = {p0, p1, p2, p3};
+    int n = bezierSegments(control, 3, tolerance);
+    float h = 1.0f / n;
+
+    // B(t) = a t^3 + b t^2 + c t + p0
+    Vec2 a = p3 - p0 + (p1 - p2) * 3.0f;
+    Vec2 b = (p0 - p1 * 2.0f + p2) * 3.0f;
+    Vec2 c = (p1 - p0) * 3.0f;
+    Vec2 point = p0;
+    Vec2 d1 = a * (h * h * h) + b * (h * h) + c * h;
+    Vec2 d2 = a * (6.0f * h * h * h) + b * (2.0f * h * h);
+    Vec2 d3 = a * (6.0f * h * h * h);
+
+    out.resize(n + 1);
+    out[0] = p0;
+    for (int i = 1; i < n; ++i) {
+        point = point + d1;
+        d1 = d1 + d2;
+        d2 = d2 + d3;
+        out[i] = point;
+    }
+    out[n] = p3;
+}
+
+// Circle tessellations around the origin keyed by radius quantized to RADIUS_STEP pixels, so an
+// animated radius revisits the same few entries instead of re-tessellating every frame.
+// Add the center when drawing.
+class CurveCache {
+public:
+    static constexpr float RADIUS_STEP = 0.25f;
+    static constexpr size_t MAX_ENTRIES = 1024; // past this the cache starts over
+
+    explicit CurveCache(float tolerance = CURVE_TOLERANCE) : tolerance(tolerance) {}
+
+    const std::vector<Vec2>& circle(float radius) {
+        int key = static_cast<int>(std::lround(radius / RADIUS_STEP));
+        auto found = circles.find(key);
+        if (found != circles.end()) return found->second;
+
+        if (circles.size() >= MAX_ENTRIES) circles.clear();
+        std::vector<Vec2>& points = circles[key];
+        tessellateCircle(Vec2{0, 0}, key * RADIUS_STEP, points, tolerance);
+        return points;
+    }
+
+    // Coarser or finer tessellation from now on; cached circles are dropped when it changes
+    void setTolerance(float newTolerance) {
+        if (newTolerance == tolerance) return;
+        tolerance = newTolerance;
+        circles.clear();
+    }
+
+    float getTolerance() const { return tolerance; }
+    void clear() { circles.clear(); }
+    size_t size() const { return circles.size(); }
+
+private:
+    float tolerance;
+    std::unordered_map<int, std::vector<Vec2>> circles;
+};
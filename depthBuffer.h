@@ -0,0 +1,117 @@
+#pragma once
+#include "framebuffer.h"
+#include "vec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Software depth buffer for hidden-line removal.
+// Stores 1/z per pixel, which interpolates linearly in screen space. Larger values are closer
+// and 0 means nothing was drawn, so clearing is a plain zero fill.
+// A coarse buffer keeps the farthest depth of each 8x8 tile so whole edges can be rejected early.
+class DepthBuffer {
+public:
+    static constexpr int TILE_SHIFT = 3;
+    static constexpr int TILE_SIZE = 1 << TILE_SHIFT;
+    static constexpr int MAX_COARSE_TILES = 16; // longer edges skip the coarse test and go per-pixel
+
+    // Relative tolerance so edges survive against the faces they lie on
+    float bias = 0.01f;
+
+    DepthBuffer(int w, int h)
+        : w(w), h(h), tilesX((w + TILE_SIZE - 1) / TILE_SIZE), tilesY((h + TILE_SIZE - 1) / TILE_SIZE),
+          depth(static_cast<size_t>(w) * h, 0.0f), tileFarthest(static_cast<size_t>(tilesX) * tilesY, 0.0f) {}
+
+    int width() const { return w; }
+    int height() const { return h; }
+
+    // New size, contents cleared
+    void resize(int newW, int newH) {
+        w = newW;
+        h = newH;
+        tilesX = (w + TILE_SIZE - 1) / TILE_SIZE;
+        tilesY = (h + TILE_SIZE - 1) / TILE_SIZE;
+        depth.assign(static_cast<size_t>(w) * h, 0.0f);
+        tileFarthest.assign(static_cast<size_t>(tilesX) * tilesY, 0.0f);
+    }
+
+    void clear() {
+        std::fill(depth.begin(), depth.end(), 0.0f);
+        std::fill(tileFarthest.begin(), tileFarthest.end(), 0.0f);
+    }
+
+    // Row access for the rasterizers that fill the buffer
+    float* row(int y) { return &depth[static_cast<size_t>(y) * w]; }
+
+    // Refresh the per-tile farthest depth, call once after all faces are drawn
+    void buildCoarse() {
+        for (int ty = 0; ty < tilesY; ++ty) {
+            for (int tx = 0; tx < tilesX; ++tx) {
+                float farthest = INFINITY;
+                int x1 = std::min(w, (tx + 1) * TILE_SIZE), y1 = std::min(h, (ty + 1) * TILE_SIZE);
+                for (int y = ty * TILE_SIZE; y < y1; ++y) {
+                    const float* row = &depth[static_cast<size_t>(y) * w];
+                    for (int x = tx * TILE_SIZE; x < x1; ++x) farthest = std::min(farthest, row[x]);
+                }
+                tileFarthest[static_cast<size_t>(ty) * tilesX + tx] = farthest;
+            }
+        }
+    }
+
+    // True when a segment whose nearest point has depth nearestZ is hidden in every tile its
+    // bounding box touches. Conservative: returns false when unsure.
+    bool coarseOccluded(float x0, float y0, float x1, float y1, float nearestZ) const {
+        int tx0 = std::max(0, static_cast<int>(std::min(x0, x1)) >> TILE_SHIFT);
+        int tx1 = std::min(tilesX - 1, static_cast<int>(std::max(x0, x1)) >> TILE_SHIFT);
+        int ty0 = std::max(0, static_cast<int>(std::min(y0, y1)) >> TILE_SHIFT);
+        int ty1 = std::min(tilesY - 1, static_cast<int>(std::max(y0, y1)) >> TILE_SHIFT);
+        if ((tx1 - tx0 + 1) * (ty1 - ty0 + 1) > MAX_COARSE_TILES) return false;
+
+        float threshold = nearestZ * (1.0f + bias);
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                if (tileFarthest[static_cast<size_t>(ty) * tilesX + tx] <= threshold) return false;
+            }
+        }
+        return true;
+    }
+
+    // Depth test without writing, z = 1/viewZ
+    bool visible(int x, int y, float z) const {
+        return z * (1.0f + bias) >= depth[static_cast<size_t>(y) * w + x];
+    }
+
+private:
+    int w, h;
+    int tilesX, tilesY;
+    std::vector<float> depth;
+    std::vector<float> tileFarthest;
+};
+
+// Draw a line whose endpoints carry 1/viewZ in z, skipping pixels hidden behind the depth buffer.
+// The depth buffer covers the framebuffer's current viewport.
+inline void drawLineDepthTested(Framebuffer& fb, const DepthBuffer& depth, const Vec3& a, const Vec3& b, uint32_t color) {
+    if (a.z <= 0 || b.z <= 0) return;
+
+    float t0, t1;
+    if (!clipLine(a.x, a.y, b.x, b.y, depth.width() - 1.0f, depth.height() - 1.0f, t0, t1)) return;
+    Vec3 p = a + (b - a) * t0;
+    Vec3 q = a + (b - a) * t1;
+
+    if (depth.coarseOccluded(p.x, p.y, q.x, q.y, std::max(p.z, q.z))) return;
+
+    float dx = q.x - p.x, dy = q.y - p.y;
+    int steps = static_cast<int>(std::max(std::fabs(dx), std::fabs(dy)));
+    float inv = steps > 0 ? 1.0f / steps : 0.0f;
+    float sx = dx * inv, sy = dy * inv, sz = (q.z - p.z) * inv;
+
+    float x = p.x + 0.5f, y = p.y + 0.5f, z = p.z;
+    for (int i = 0; i <= steps; ++i) {
+        int px = static_cast<int>(x), py = static_cast<int>(y);
+        if (depth.visible(px, py, z)) fb.put(px, py, color);
+        x += sx;
+        y += sy;
+        z += sz;
+    }
+}
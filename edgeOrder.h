@@ -0,0 +1,226 @@
+#pragma once
+#include "parallel.h"
+#include "vec.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Edge submission order for raster locality. Edges sorted by the Morton (Z-order) code of their
+// midpoint come out in runs that stay inside one screen region, so consecutive lines write to
+// framebuffer memory that is still in cache instead of jumping across the frame.
+//
+// Per frame: mortonEdgeOrder() sorts by projected midpoints with a parallel radix sort whose
+// buffers come from a FrameArena. Whether it pays for itself depends on the layout and the
+// machine: with tiles the framebuffer already has most of the locality, and the sort can cost
+// more than it saves (framebufferBench measures both layouts).
+// Meshes that are not animated, under a camera that does not move: mortonSortEdges() reorders
+// the edge list once, by object-space midpoints, at no per-frame cost.
+enum class EdgeOrdering { AsGiven, ScreenMorton, ObjectMorton };
+
+inline const char* edgeOrderingName(EdgeOrdering ordering) {
+    switch (ordering) {
+    case EdgeOrdering::AsGiven: return "as given";
+    case EdgeOrdering::ScreenMorton: return "screen Morton";
+    case EdgeOrdering::ObjectMorton: return "object Morton";
+    default: return "?";
+    }
+}
+
+// Bump allocator for per-frame scratch. Allocations live until reset(); a frame that outgrows
+// the block spills into extra blocks, and the next reset() replaces them with one block big
+// enough for the whole frame, so steady frames allocate nothing.
+class FrameArena {
+public:
+    static constexpr size_t ALIGNMENT = 64; // whole cache lines, so per-thread slices do not share one
+
+    explicit FrameArena(size_t bytes = size_t(1) << 20) { grow(bytes); }
+
+    template <typename T>
+    T* allocate(size_t count) {
+        size_t bytes = (count * sizeof(T) + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        if (used + bytes > blocks.back().size) grow(std::max(bytes, blocks.back().size * 2));
+        T* memory = reinterpret_cast<T*>(blocks.back().memory + used);
+        used += bytes;
+        frameBytes += bytes;
+        return memory;
+    }
+
+    void reset() {
+        if (blocks.size() > 1) {
+            size_t peak = frameBytes;
+            blocks.clear();
+            grow(peak);
+        }
+        used = 0;
+        frameBytes = 0;
+    }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& block : blocks) total += block.size;
+        return total;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> storage;
+        unsigned char* memory; // storage rounded up to ALIGNMENT
+        size_t size;
+    };
+
+    void grow(size_t bytes) {
+        Block block;
+        block.storage.reset(new unsigned char[bytes + ALIGNMENT]);
+        size_t misalignment = reinterpret_cast<uintptr_t>(block.storage.get()) & (ALIGNMENT - 1);
+        block.memory = block.storage.get() + (misalignment ? ALIGNMENT - misalignment : 0);
+        block.size = bytes;
+        blocks.push_back(std::move(block));
+        used = 0;
+    }
+
+    std::vector<Block> blocks;
+    size_t used = 0;       // in the newest block
+    size_t frameBytes = 0; // across all blocks since reset()
+};
+
+// Interleaves the low 16 bits of x and y: x on the even bits, y on the odd ones
+inline uint32_t mortonCode2D(uint32_t x, uint32_t y) {
+    auto spread = [](uint32_t v) {
+        v &= 0xFFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | spread(y) << 1;
+}
+
+// Interleaves the low 10 bits of x, y and z
+inline uint32_t mortonCode3D(uint32_t x, uint32_t y, uint32_t z) {
+    auto spread = [](uint32_t v) {
+        v &= 0x3FF;
+        v = (v | (v << 16)) & 0x030000FF;
+        v = (v | (v << 8)) & 0x0300F00F;
+        v = (v | (v << 4)) & 0x030C30C3;
+        v = (v | (v << 2)) & 0x09249249;
+        return v;
+    };
+    return spread(x) | spread(y) << 1 | spread(z) << 2;
+}
+
+// Stable LSD radix sort of (key, value) pairs by key, 8 bits per pass. Each pass splits the input
+// into one slice per thread: the slices count their digits in parallel, a prefix sum over
+// (digit, slice) gives every slice its own output ranges, and the slices scatter in parallel.
+// Passes whose digit is the same for every key are skipped, so keys that only use their low
+// bits (Morton codes of a small screen) cost fewer passes. Scratch comes from the arena.
+constexpr int RADIX_BITS = 8;
+constexpr int RADIX_BUCKETS = 1 << RADIX_BITS;
+constexpr size_t RADIX_MIN_SLICE = 16384; // fewer pairs per thread are not worth a thread
+
+inline void radixSortPairs(uint32_t* keys, uint32_t* values, size_t count, FrameArena& arena, int threadCount = 0) {
+    if (count < 2) return;
+    if (threadCount <= 0) threadCount = workerCount();
+    int slices = static_cast<int>(std::clamp<size_t>(count / RADIX_MIN_SLICE, 1, static_cast<size_t>(threadCount)));
+
+    uint32_t* keyScratch = arena.allocate<uint32_t>(count);
+    uint32_t* valueScratch = arena.allocate<uint32_t>(count);
+    size_t* histograms = arena.allocate<size_t>(static_cast<size_t>(slices) * RADIX_BUCKETS);
+    auto sliceBegin = [&](int s) { return count * s / slices; };
+
+    uint32_t* inKeys = keys;
+    uint32_t* inValues = values;
+    uint32_t* outKeys = keyScratch;
+    uint32_t* outValues = valueScratch;
+    for (int shift = 0; shift < 32; shift += RADIX_BITS) {
+        parallelFor(slices, [&](int s) {
+            size_t* histogram = &histograms[static_cast<size_t>(s) * RADIX_BUCKETS];
+            std::fill(histogram, histogram + RADIX_BUCKETS, size_t(0));
+            for (size_t i = sliceBegin(s), end = sliceBegin(s + 1); i < end; ++i) histogram[(inKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+        }, slices);
+
+        // Skip the pass when one digit holds every key
+        bool trivial = false;
+        for (int d = 0; d < RADIX_BUCKETS && !trivial; ++d) {
+            size_t total = 0;
+            for (int s = 0; s < slices; ++s) total += histograms[static_cast<size_t>(s) * RADIX_BUCKETS + d];
+            trivial = total == count;
+        }
+        if (trivial) continue;
+
+        // Histograms become output offsets: digit-major, then slice order, which keeps it stable
+        size_t offset = 0;
+        for (int d = 0; d < RADIX_BUCKETS; ++d) {
+            for (int s = 0; s < slices; ++s) {
+                size_t& slot = histograms[static_cast<size_t>(s) * RADIX_BUCKETS + d];
+                size_t n = slot;
+                slot = offset;
+                offset += n;
+            }
+        }
+
+        parallelFor(slices, [&](int s) {
+            size_t* next = &histograms[static_cast<size_t>(s) * RADIX_BUCKETS];
+            for (size_t i = sliceBegin(s), end = sliceBegin(s + 1); i < end; ++i) {
+                size_t at = next[(inKeys[i] >> shift) & (RADIX_BUCKETS - 1)]++;
+                outKeys[at] = inKeys[i];
+                outValues[at] = inValues[i];
+            }
+        }, slices);
+        std::swap(inKeys, outKeys);
+        std::swap(inValues, outValues);
+    }
+
+    if (inKeys != keys) {
+        std::memcpy(keys, inKeys, count * sizeof(uint32_t));
+        std::memcpy(values, inValues, count * sizeof(uint32_t));
+    }
+}
+
+// Edge indices in Morton order of their projected midpoints (screen x, y in pixels). The returned
+// array holds edges.size() indices and lives in the arena until its next reset().
+inline const uint32_t* mortonEdgeOrder(const std::vector<std::pair<int, int>>& edges, const Vec3* projected, FrameArena& arena,
+                                       int threadCount = 0) {
+    size_t count = edges.size();
+    uint32_t* keys = arena.allocate<uint32_t>(count);
+    uint32_t* order = arena.allocate<uint32_t>(count);
+    for (size_t e = 0; e < count; ++e) {
+        const Vec3& a = projected[edges[e].first];
+        const Vec3& b = projected[edges[e].second];
+        // Off-screen midpoints clamp to the border, which keeps them together at the ends
+        float x = std::clamp((a.x + b.x) * 0.5f, 0.0f, 65535.0f);
+        float y = std::clamp((a.y + b.y) * 0.5f, 0.0f, 65535.0f);
+        keys[e] = mortonCode2D(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+        order[e] = static_cast<uint32_t>(e);
+    }
+    radixSortPairs(keys, order, count, arena, threadCount);
+    return order;
+}
+
+// Reorders edges once by the Morton code of their midpoints in the points' bounding box, 10 bits
+// per axis. For views whose camera does not move, object-space order is screen-space order.
+inline void mortonSortEdges(std::vector<std::pair<int, int>>& edges, const std::vector<Vec3>& points) {
+    if (edges.size() < 2 || points.empty()) return;
+    Vec3 lo = points[0], hi = points[0];
+    for (const Vec3& p : points) {
+        lo = minVec(lo, p);
+        hi = maxVec(hi, p);
+    }
+    Vec3 extent = hi - lo;
+    auto cell = [](float v, float low, float size) {
+        return size > 0 ? static_cast<uint32_t>(std::clamp((v - low) / size, 0.0f, 1.0f) * 1023.0f) : 0u;
+    };
+
+    std::vector<std::pair<uint32_t, std::pair<int, int>>> keyed;
+    keyed.reserve(edges.size());
+    for (const auto& edge : edges) {
+        Vec3 mid = (points[edge.first] + points[edge.second]) * 0.5f;
+        keyed.emplace_back(mortonCode3D(cell(mid.x, lo.x, extent.x), cell(mid.y, lo.y, extent.y), cell(mid.z, lo.z, extent.z)), edge);
+    }
+    std::stable_sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < edges.size(); ++i) edges[i] = keyed[i].second;
+}
@@ -0,0 +1,214 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// Pack an 8-bit RGBA color into the ARGB8888 layout the framebuffer stores
+inline uint32_t packColor(int r, int g, int b, int a = 255) {
+    return (static_cast<uint32_t>(a) << 24) | (static_cast<uint32_t>(r) << 16) |
+           (static_cast<uint32_t>(g) << 8) | static_cast<uint32_t>(b);
+}
+
+// Source-over blend of color's RGB onto dst at the given 0..255 alpha, integer math only. Per channel
+// the result is (d * (255 - a) + s * a + 255) >> 8: exact at alpha 0 and 255 and within one of the
+// true d + (s - d) * a / 255 between. The source alpha is 255, so alpha comes out as a + dstAlpha * (1 - a).
+// Untouched (alpha 0) pixels take the color as is, so the framebuffer upload blends it over SDL's output.
+inline uint32_t blendColor(uint32_t dst, uint32_t color, int alpha) {
+    // All four channels at once in the 16-bit lanes of a 64-bit word (0x00AA00GG00RR00BB), where
+    // each channel's sum fits
+    auto expand = [](uint32_t c) { return (static_cast<uint64_t>(c & 0xFF00FF00u) << 24) | (c & 0x00FF00FFu); };
+    uint64_t a = static_cast<uint64_t>(alpha);
+    uint64_t v = (expand(dst) * (255 - a) + expand(color | 0xFF000000u) * a + 0x00FF00FF00FF00FFull) >> 8;
+    v &= 0x00FF00FF00FF00FFull;
+    uint32_t blended = static_cast<uint32_t>(v & 0x00FF00FFu) | (static_cast<uint32_t>(v >> 24) & 0xFF00FF00u);
+    uint32_t fresh = (color & 0xFFFFFFu) | (static_cast<uint32_t>(alpha) << 24);
+
+    // Masks rather than a branch: whether a pixel was touched before is close to random where
+    // shapes overlap. untouched is all ones when the old alpha is 0 ((0 - 1) >> 31 == 1).
+    uint32_t untouched = 0u - (((dst >> 24) - 1u) >> 31);
+    return (fresh & untouched) | (blended & ~untouched);
+}
+
+// Pixel order in memory. Linear is row after row. Tiled stores FRAMEBUFFER_TILE^2 pixel tiles
+// one after another, row-major, with the pixels of each tile in Morton (Z) order: every 4x4
+// block is one 64-byte cache line, so a steep line reaches a new cache line every fourth row
+// instead of every row. Tiled buffers are converted back to rows once, at upload (linearData()).
+enum class FramebufferLayout { Linear, Tiled };
+
+constexpr int FRAMEBUFFER_TILE_SHIFT = 3;
+constexpr int FRAMEBUFFER_TILE = 1 << FRAMEBUFFER_TILE_SHIFT;
+constexpr int FRAMEBUFFER_TILE_PIXELS = FRAMEBUFFER_TILE * FRAMEBUFFER_TILE;
+
+// Morton offset of pixel (x, y) inside a tile, x and y in [0, FRAMEBUFFER_TILE): x takes the
+// even bits, y the odd ones
+inline size_t tileMorton(size_t x, size_t y) {
+    size_t spreadX = (x & 1) | (x & 2) << 1 | (x & 4) << 2;
+    size_t spreadY = (y & 1) | (y & 2) << 1 | (y & 4) << 2;
+    return spreadX | spreadY << 1;
+}
+
+// CPU-side ARGB8888 color buffer for the software raster paths.
+// Like SDL_RenderSetViewport, setViewport() makes every coordinate relative to a sub-rectangle,
+// and width()/height() report the size of that rectangle.
+class Framebuffer {
+    std::vector<uint32_t> pixels;
+    std::vector<uint32_t> linear; // tiled layout only: rows for upload
+    int bufferWidth = 0, bufferHeight = 0;
+    int viewX = 0, viewY = 0, viewWidth = 0, viewHeight = 0;
+    bool tiled = false;
+    // Addressing kept as size_t: pixel stores are uint32_t and may alias int members, which would
+    // make the compiler reload the viewport after every store in a drawing loop
+    size_t stride = 0, viewOrigin = 0;
+    size_t viewLeft = 0, viewTop = 0, tileRowPixels = 0; // tiled addressing
+    size_t rightSteps[FRAMEBUFFER_TILE] = {}, downSteps[FRAMEBUFFER_TILE] = {};
+
+public:
+    Framebuffer(int w, int h, FramebufferLayout layout = FramebufferLayout::Linear) : tiled(layout == FramebufferLayout::Tiled) {
+        resize(w, h);
+    }
+
+    void resize(int w, int h) {
+        bufferWidth = w;
+        bufferHeight = h;
+        stride = static_cast<size_t>(w);
+        if (tiled) {
+            // Whole tiles, so edge tiles need no special case
+            size_t tilesX = (static_cast<size_t>(w) + FRAMEBUFFER_TILE - 1) >> FRAMEBUFFER_TILE_SHIFT;
+            size_t tilesY = (static_cast<size_t>(h) + FRAMEBUFFER_TILE - 1) >> FRAMEBUFFER_TILE_SHIFT;
+            tileRowPixels = tilesX * FRAMEBUFFER_TILE_PIXELS;
+            pixels.assign(tilesY * tileRowPixels, 0);
+            linear.assign(static_cast<size_t>(w) * h, 0);
+        } else {
+            pixels.assign(static_cast<size_t>(w) * h, 0);
+            linear = std::vector<uint32_t>();
+        }
+        for (size_t i = 0; i < FRAMEBUFFER_TILE; ++i) {
+            // The last column or row of a tile steps into the next tile
+            size_t next = i + 1 < FRAMEBUFFER_TILE ? i + 1 : 0;
+            rightSteps[i] = tiled ? tileMorton(next, 0) + (next == 0 ? FRAMEBUFFER_TILE_PIXELS : 0) - tileMorton(i, 0) : 1;
+            downSteps[i] = tiled ? tileMorton(0, next) + (next == 0 ? tileRowPixels : 0) - tileMorton(0, i) : stride;
+        }
+        resetViewport();
+    }
+
+    // Switching layout reallocates and clears the buffer
+    void setLayout(FramebufferLayout layout) {
+        if (tiled == (layout == FramebufferLayout::Tiled)) return;
+        tiled = layout == FramebufferLayout::Tiled;
+        resize(bufferWidth, bufferHeight);
+    }
+    FramebufferLayout layout() const { return tiled ? FramebufferLayout::Tiled : FramebufferLayout::Linear; }
+
+    void setViewport(int x, int y, int w, int h) {
+        viewX = std::max(x, 0);
+        viewY = std::max(y, 0);
+        viewWidth = std::min(w, bufferWidth - viewX);
+        viewHeight = std::min(h, bufferHeight - viewY);
+        viewOrigin = static_cast<size_t>(viewY) * stride + viewX;
+        viewLeft = static_cast<size_t>(viewX);
+        viewTop = static_cast<size_t>(viewY);
+    }
+
+    void resetViewport() { setViewport(0, 0, bufferWidth, bufferHeight); }
+
+    // Clears the whole buffer, ignoring the viewport. 0 is fully transparent black.
+    void clear(uint32_t color = 0) { std::fill(pixels.begin(), pixels.end(), color); }
+
+    int width() const { return viewWidth; }
+    int height() const { return viewHeight; }
+
+    // Addressing helper: every rasterizer goes through this to find a pixel
+    size_t index(int x, int y) const {
+        if (!tiled) return viewOrigin + static_cast<size_t>(y) * stride + static_cast<size_t>(x);
+        size_t px = viewLeft + static_cast<size_t>(x), py = viewTop + static_cast<size_t>(y);
+        return (py >> FRAMEBUFFER_TILE_SHIFT) * tileRowPixels + (px >> FRAMEBUFFER_TILE_SHIFT) * FRAMEBUFFER_TILE_PIXELS +
+               tileMorton(px & (FRAMEBUFFER_TILE - 1), py & (FRAMEBUFFER_TILE - 1));
+    }
+
+    // index(x + 1, y) - index(x, y) and index(x, y + 1) - index(x, y), for loops that walk to
+    // neighbouring pixels instead of addressing each one. Tiled steps depend on where x or y
+    // falls in its tile, so both come from small per-layout tables, without a branch.
+    size_t rightStep(int x) const { return rightSteps[(viewLeft + static_cast<size_t>(x)) & (FRAMEBUFFER_TILE - 1)]; }
+    size_t downStep(int y) const { return downSteps[(viewTop + static_cast<size_t>(y)) & (FRAMEBUFFER_TILE - 1)]; }
+
+    // Unchecked, callers clip to width()/height() first
+    void put(int x, int y, uint32_t color) { pixels[index(x, y)] = color; }
+    uint32_t get(int x, int y) const { return pixels[index(x, y)]; }
+
+    // Horizontal run x0..x1 (inclusive) on row y, clipped to the viewport
+    void fillSpan(int y, int x0, int x1, uint32_t color) {
+        if (y < 0 || y >= viewHeight) return;
+        x0 = std::max(x0, 0);
+        x1 = std::min(x1, viewWidth - 1);
+        if (x0 > x1) return;
+        if (!tiled) {
+            std::fill_n(&pixels[index(x0, y)], x1 - x0 + 1, color);
+            return;
+        }
+        // Tiled rows are only contiguous in pairs; the row's Morton bits and tile row are fixed
+        size_t py = viewTop + static_cast<size_t>(y);
+        size_t row = (py >> FRAMEBUFFER_TILE_SHIFT) * tileRowPixels + tileMorton(0, py & (FRAMEBUFFER_TILE - 1));
+        for (size_t px = viewLeft + x0, end = viewLeft + x1; px <= end; ++px) {
+            pixels[row + (px >> FRAMEBUFFER_TILE_SHIFT) * FRAMEBUFFER_TILE_PIXELS + tileMorton(px & (FRAMEBUFFER_TILE - 1), 0)] = color;
+        }
+    }
+
+    // Source-over blend (see blendColor). Unchecked like put().
+    void blend(int x, int y, uint32_t color, int alpha) {
+        uint32_t& dst = pixels[index(x, y)];
+        dst = blendColor(dst, color, alpha);
+    }
+
+    // Whole buffer in row order for uploading, rows are bufferWidth pixels apart. A tiled
+    // buffer is converted here: tiles are read in storage order and each tile row goes out as
+    // FRAMEBUFFER_TILE pixels gathered from its Morton positions.
+    const uint32_t* linearData() {
+        if (!tiled) return pixels.data();
+        static constexpr size_t ROW_ORDER[FRAMEBUFFER_TILE] = {0, 1, 4, 5, 16, 17, 20, 21}; // tileMorton(x, 0)
+        const uint32_t* tile = pixels.data();
+        for (int ty = 0; ty < bufferHeight; ty += FRAMEBUFFER_TILE) {
+            int rows = std::min(FRAMEBUFFER_TILE, bufferHeight - ty);
+            for (int tx = 0; tx < bufferWidth; tx += FRAMEBUFFER_TILE, tile += FRAMEBUFFER_TILE_PIXELS) {
+                int columns = std::min(FRAMEBUFFER_TILE, bufferWidth - tx);
+                for (int r = 0; r < rows; ++r) {
+                    const uint32_t* in = tile + tileMorton(0, static_cast<size_t>(r));
+                    uint32_t* out = &linear[static_cast<size_t>(ty + r) * stride + tx];
+                    if (columns == FRAMEBUFFER_TILE) {
+                        for (int x = 0; x < FRAMEBUFFER_TILE; ++x) out[x] = in[ROW_ORDER[x]];
+                    } else {
+                        for (int x = 0; x < columns; ++x) out[x] = in[ROW_ORDER[x]];
+                    }
+                }
+            }
+        }
+        return linear.data();
+    }
+
+    // Raw storage in the buffer's own layout
+    const uint32_t* data() const { return pixels.data(); }
+    uint32_t* data() { return pixels.data(); }
+    int pitch() const { return bufferWidth * static_cast<int>(sizeof(uint32_t)); }
+    int fullWidth() const { return bufferWidth; }
+    int fullHeight() const { return bufferHeight; }
+};
+
+// Liang-Barsky clip of the segment (x0,y0)-(x1,y1) against [0, maxX] x [0, maxY].
+// On success t0/t1 hold the visible parameter range, so callers can clip their own attributes.
+inline bool clipLine(float x0, float y0, float x1, float y1, float maxX, float maxY, float& t0, float& t1) {
+    float dx = x1 - x0, dy = y1 - y0;
+    float p[4] = {-dx, dx, -dy, dy};
+    float q[4] = {x0, maxX - x0, y0, maxY - y0};
+
+    t0 = 0;
+    t1 = 1;
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0) {
+            if (q[i] < 0) return false;
+            continue;
+        }
+        float t = q[i] / p[i];
+        if (p[i] < 0) t0 = std::max(t0, t);
+        else t1 = std::min(t1, t);
+    }
+    return t0 <= t1;
+}
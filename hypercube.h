@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <utility>
+
+// Fixed-dimension vector. Every operation expands over an index sequence, so the loops over
+// the N components are unrolled at compile time and the compiler can vectorize across them.
+template <int N>
+struct Vec {
+    float v[N];
+
+    constexpr float& operator[](int i) { return v[i]; }
+    constexpr const float& operator[](int i) const { return v[i]; }
+
+    constexpr Vec operator+(const Vec& o) const { return zip(o, std::make_index_sequence<N>{}, 1.0f); }
+    constexpr Vec operator-(const Vec& o) const { return zip(o, std::make_index_sequence<N>{}, -1.0f); }
+    constexpr Vec operator*(float s) const { return scaled(s, std::make_index_sequence<N>{}); }
+    constexpr float dot(const Vec& o) const { return dotImpl(o, std::make_index_sequence<N>{}); }
+
+    // Givens rotation in the plane of axes I and J
+    template <int I, int J>
+    constexpr Vec rotated(float c, float s) const {
+        static_assert(I >= 0 && J >= 0 && I < N && J < N && I != J, "rotation plane out of range");
+        Vec r = *this;
+        r.v[I] = v[I] * c - v[J] * s;
+        r.v[J] = v[I] * s + v[J] * c;
+        return r;
+    }
+
+    // Perspective divide along the last axis, viewed from distance on that axis
+    constexpr Vec<N - 1> project(float distance) const {
+        return dropLast(distance / (distance - v[N - 1]), std::make_index_sequence<N - 1>{});
+    }
+
+private:
+    template <size_t... I>
+    constexpr Vec zip(const Vec& o, std::index_sequence<I...>, float sign) const { return Vec{{(v[I] + sign * o.v[I])...}}; }
+
+    template <size_t... I>
+    constexpr Vec scaled(float s, std::index_sequence<I...>) const { return Vec{{(v[I] * s)...}}; }
+
+    template <size_t... I>
+    constexpr float dotImpl(const Vec& o, std::index_sequence<I...>) const { return (0.0f + ... + (v[I] * o.v[I])); }
+
+    template <size_t... I>
+    constexpr Vec<N - 1> dropLast(float s, std::index_sequence<I...>) const { return Vec<N - 1>{{(v[I] * s)...}}; }
+};
+
+// N-cube generated at compile time: 2^N vertices at +-HALF_SIZE and N * 2^(N-1) edges.
+// Vertex i has bit d of i set when its coordinate d is positive, so neighbours differ in one bit.
+// Edges are grouped by the axis they run along.
+template <int N>
+struct Hypercube {
+    static_assert(N >= 1 && N <= 12, "Hypercube dimension out of range");
+
+    static constexpr float HALF_SIZE = 0.5f;
+    static constexpr int VERTEX_COUNT = 1 << N;
+    static constexpr int EDGE_COUNT = N << (N - 1);
+
+    static constexpr Vec<N> vertex(int i) { return vertexImpl(i, std::make_index_sequence<N>{}); }
+
+    // Edge k runs along axis k / 2^(N-1); the remaining bits pick the corner it starts from
+    static constexpr std::pair<int, int> edge(int k) {
+        int axis = k >> (N - 1);
+        int j = k & ((1 << (N - 1)) - 1);
+        int low = j & ((1 << axis) - 1);
+        int high = (j >> axis) << (axis + 1);
+        return std::pair<int, int>(high | low, high | low | (1 << axis));
+    }
+
+private:
+    template <size_t... D>
+    static constexpr Vec<N> vertexImpl(int i, std::index_sequence<D...>) {
+        return Vec<N>{{(((i >> D) & 1) ? HALF_SIZE : -HALF_SIZE)...}};
+    }
+
+    template <size_t... I>
+    static constexpr std::array<Vec<N>, VERTEX_COUNT> makeVertices(std::index_sequence<I...>) {
+        return {{vertex(static_cast<int>(I))...}};
+    }
+
+    template <size_t... K>
+    static constexpr std::array<std::pair<int, int>, EDGE_COUNT> makeEdges(std::index_sequence<K...>) {
+        return {{edge(static_cast<int>(K))...}};
+    }
+
+public:
+    static constexpr std::array<Vec<N>, VERTEX_COUNT> vertices = makeVertices(std::make_index_sequence<VERTEX_COUNT>{});
+    static constexpr std::array<std::pair<int, int>, EDGE_COUNT> edges = makeEdges(std::make_index_sequence<EDGE_COUNT>{});
+};
@@ -0,0 +1,125 @@
+#pragma once
+#include "depthBuffer.h"
+#include "framebuffer.h"
+#include "vec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// Software line drawing with per-vertex ARGB colors.
+// Position and the four channels step in 16.16 fixed point: the only divisions are one per line
+// to set up the steps. Pixels are produced LINE_LANES at a time as block start + lane offset,
+// with no dependency between lanes, so the lane loop vectorizes.
+constexpr int LINE_LANES = 8;
+
+inline int32_t toFixed16(float v) { return static_cast<int32_t>(std::lround(v * 65536.0f)); }
+
+// Color a fraction t of the way from c0 to c1, per channel
+inline uint32_t lerpColor(uint32_t c0, uint32_t c1, float t) {
+    uint32_t c = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        float a = static_cast<float>((c0 >> shift) & 0xFF);
+        float b = static_cast<float>((c1 >> shift) & 0xFF);
+        c |= static_cast<uint32_t>(a + (b - a) * t + 0.5f) << shift;
+    }
+    return c;
+}
+
+// Shared stepping for the gradient lines. a and b are already clipped to the framebuffer;
+// DEPTH_TEST reads z as 1/z and tests every pixel against depth.
+// Steps are rounded up so neither coordinate moves more than one pixel per step: only the first
+// pixel is addressed, the rest are reached by one rightStep/downStep per axis that moves.
+template <bool DEPTH_TEST>
+inline void rasterGradientLine(Framebuffer& fb, const DepthBuffer* depth, const Vec3& a, const Vec3& b, uint32_t ca, uint32_t cb) {
+    float dx = b.x - a.x, dy = b.y - a.y;
+    int steps = static_cast<int>(std::ceil(std::max(std::fabs(dx), std::fabs(dy))));
+    float inv = steps > 0 ? 1.0f / steps : 0.0f;
+
+    int32_t x = toFixed16(a.x + 0.5f), y = toFixed16(a.y + 0.5f);
+    int32_t sx = toFixed16(dx * inv), sy = toFixed16(dy * inv);
+    float sz = (b.z - a.z) * inv;
+
+    // Channels 0..3 are b, g, r, a (the byte order of the packed color)
+    int32_t channel[4], channelStep[4];
+    for (int k = 0; k < 4; ++k) {
+        int32_t c0 = (ca >> (8 * k)) & 0xFF, c1 = (cb >> (8 * k)) & 0xFF;
+        channel[k] = (c0 << 16) + (1 << 15);
+        channelStep[k] = steps > 0 ? ((c1 - c0) * 65536) / steps : 0;
+    }
+
+    // Lane l sits l steps past the block's start; the starts advance LINE_LANES steps per block
+    int32_t offsetX[LINE_LANES], offsetY[LINE_LANES], offsetChannel[4][LINE_LANES];
+    float offsetZ[LINE_LANES];
+    for (int l = 0; l < LINE_LANES; ++l) {
+        offsetX[l] = l * sx;
+        offsetY[l] = l * sy;
+        for (int k = 0; k < 4; ++k) offsetChannel[k][l] = l * channelStep[k];
+        offsetZ[l] = static_cast<float>(l) * sz;
+    }
+    float z = a.z;
+
+    uint32_t* pixels = fb.data();
+    int lastX = x >> 16, lastY = y >> 16;
+    size_t at = fb.index(lastX, lastY);
+    // Signed step for each position of the last pixel in its tile: a step forward is the step out
+    // of the last pixel, a step back the negated step out of the new one
+    size_t stepX[FRAMEBUFFER_TILE], stepY[FRAMEBUFFER_TILE];
+    for (int k = 0; k < FRAMEBUFFER_TILE; ++k) {
+        stepX[k] = sx >= 0 ? fb.rightStep(k) : 0 - fb.rightStep(k - 1);
+        stepY[k] = sy >= 0 ? fb.downStep(k) : 0 - fb.downStep(k - 1);
+    }
+    int32_t px[LINE_LANES], py[LINE_LANES];
+    uint32_t color[LINE_LANES];
+    float pz[LINE_LANES];
+    for (int i0 = 0; i0 <= steps; i0 += LINE_LANES) {
+        for (int l = 0; l < LINE_LANES; ++l) {
+            px[l] = (x + offsetX[l]) >> 16;
+            py[l] = (y + offsetY[l]) >> 16;
+            // The integer part of channel k sits in bits 16..23, move it to bits 8k..8k+7
+            uint32_t c0 = static_cast<uint32_t>(channel[0] + offsetChannel[0][l]);
+            uint32_t c1 = static_cast<uint32_t>(channel[1] + offsetChannel[1][l]);
+            uint32_t c2 = static_cast<uint32_t>(channel[2] + offsetChannel[2][l]);
+            uint32_t c3 = static_cast<uint32_t>(channel[3] + offsetChannel[3][l]);
+            color[l] = ((c3 & 0xFF0000u) << 8) | (c2 & 0xFF0000u) | ((c1 >> 8) & 0xFF00u) | (c0 >> 16);
+            if (DEPTH_TEST) pz[l] = z + offsetZ[l];
+        }
+
+        int n = std::min(LINE_LANES, steps + 1 - i0);
+        for (int l = 0; l < n; ++l) {
+            // Masks, not branches: whether an axis moves at a step follows the slope
+            size_t moveX = 0 - static_cast<size_t>(px[l] != lastX), moveY = 0 - static_cast<size_t>(py[l] != lastY);
+            at += (stepX[lastX & (FRAMEBUFFER_TILE - 1)] & moveX) + (stepY[lastY & (FRAMEBUFFER_TILE - 1)] & moveY);
+            lastX = px[l];
+            lastY = py[l];
+            if (!DEPTH_TEST || depth->visible(px[l], py[l], pz[l])) pixels[at] = color[l];
+        }
+
+        x += LINE_LANES * sx;
+        y += LINE_LANES * sy;
+        for (int k = 0; k < 4; ++k) channel[k] += LINE_LANES * channelStep[k];
+        z += LINE_LANES * sz;
+    }
+}
+
+// Line from (x0, y0) in color c0 to (x1, y1) in color c1, clipped to the viewport
+inline void drawLineGradient(Framebuffer& fb, float x0, float y0, float x1, float y1, uint32_t c0, uint32_t c1) {
+    float t0, t1;
+    if (!clipLine(x0, y0, x1, y1, fb.width() - 1.0f, fb.height() - 1.0f, t0, t1)) return;
+    float dx = x1 - x0, dy = y1 - y0;
+    Vec3 p{x0 + dx * t0, y0 + dy * t0, 0};
+    Vec3 q{x0 + dx * t1, y0 + dy * t1, 0};
+    rasterGradientLine<false>(fb, nullptr, p, q, lerpColor(c0, c1, t0), lerpColor(c0, c1, t1));
+}
+
+// Gradient version of drawLineDepthTested: a and b hold screen x, y and 1/z
+inline void drawLineGradientDepthTested(Framebuffer& fb, const DepthBuffer& depth, const Vec3& a, const Vec3& b, uint32_t ca, uint32_t cb) {
+    if (a.z <= 0 || b.z <= 0) return;
+
+    float t0, t1;
+    if (!clipLine(a.x, a.y, b.x, b.y, depth.width() - 1.0f, depth.height() - 1.0f, t0, t1)) return;
+    Vec3 p = a + (b - a) * t0;
+    Vec3 q = a + (b - a) * t1;
+
+    if (depth.coarseOccluded(p.x, p.y, q.x, q.y, std::max(p.z, q.z))) return;
+    rasterGradientLine<true>(fb, &depth, p, q, lerpColor(ca, cb, t0), lerpColor(ca, cb, t1));
+}
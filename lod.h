@@ -0,0 +1,275 @@
+#pragma once
+#include "polytope.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+// Level-of-detail chains for wireframe polytopes, built by quadric edge collapse.
+//
+// Each vertex carries a quadric: the sum of squared distances to the lines of the edges that
+// have been merged into it (Garland-Heckbert with edge lines standing in for faces). Collapsing
+// an edge moves both ends to whichever of the two ends or their midpoint has the lowest summed
+// quadric and merges every edge that becomes a duplicate. Cheapest collapses go first, so the
+// shape's silhouette survives longest. Works in the polytope's own N dimensions.
+// The quadric only orders the collapses; the error reported per level is a plain distance bound
+// (see LodLevel::error) so it converts straight to pixels.
+constexpr int LOD_MAX_LEVELS = 8;
+constexpr float LOD_LEVEL_RATIO = 0.5f; // each level keeps about this fraction of the previous edges
+constexpr int LOD_MIN_EDGES = 8;
+
+struct LodLevel {
+    Polytope mesh;
+    float error = 0; // farthest any original vertex sits from the vertex it was merged into, in model units
+};
+
+// Quadric over N-dimensional points: Q(p) = p^T A p + 2 b.p + c, A symmetric
+class EdgeQuadric {
+public:
+    explicit EdgeQuadric(int n = 0) : n(n), a(static_cast<size_t>(n) * n, 0.0), b(n, 0.0) {}
+
+    // Squared distance to the line through p0 with unit direction d: A = I - d d^T, b = -A p0, c = p0.A p0
+    void addLine(const double* p0, const double* d) {
+        double pd = 0;
+        for (int i = 0; i < n; ++i) pd += p0[i] * d[i];
+        for (int i = 0; i < n; ++i) {
+            // (A p0)_i = p0_i - d_i (d . p0)
+            double ap = p0[i] - d[i] * pd;
+            b[i] -= ap;
+            c += p0[i] * ap;
+            for (int j = 0; j < n; ++j) a[static_cast<size_t>(i) * n + j] += (i == j ? 1.0 : 0.0) - d[i] * d[j];
+        }
+    }
+
+    void add(const EdgeQuadric& other) {
+        for (size_t i = 0; i < a.size(); ++i) a[i] += other.a[i];
+        for (int i = 0; i < n; ++i) b[i] += other.b[i];
+        c += other.c;
+    }
+
+    double evaluate(const double* p) const {
+        double q = c;
+        for (int i = 0; i < n; ++i) {
+            double row = 0;
+            for (int j = 0; j < n; ++j) row += a[static_cast<size_t>(i) * n + j] * p[j];
+            q += p[i] * row + 2 * b[i] * p[i];
+        }
+        return q;
+    }
+
+private:
+    int n;
+    std::vector<double> a, b;
+    double c = 0;
+};
+
+// Collapses edges of one polytope, cheapest first
+class EdgeCollapser {
+public:
+    explicit EdgeCollapser(const Polytope& base) : n(base.dimension), positions(static_cast<size_t>(base.count) * base.dimension) {
+        int count = base.count;
+        for (int v = 0; v < count; ++v) {
+            for (int d = 0; d < n; ++d) positions[static_cast<size_t>(v) * n + d] = base.axis(d)[v];
+        }
+        originals = positions;
+        quadrics.assign(count, EdgeQuadric(n));
+        neighbors.resize(count);
+        stamps.assign(count, 0);
+        alive.assign(count, 1);
+        members.resize(count);
+        for (int v = 0; v < count; ++v) members[v].push_back(v);
+
+        std::vector<double> direction(n);
+        for (const auto& edge : base.edges) {
+            int u = edge.first, v = edge.second;
+            if (u == v || std::find(neighbors[u].begin(), neighbors[u].end(), v) != neighbors[u].end()) continue;
+            neighbors[u].push_back(v);
+            neighbors[v].push_back(u);
+            edgeCount++;
+
+            if (!unitDirection(u, v, direction.data())) continue;
+            quadrics[u].addLine(position(u), direction.data());
+            quadrics[v].addLine(position(u), direction.data());
+        }
+        for (int u = 0; u < count; ++u) {
+            for (int v : neighbors[u]) {
+                if (u < v) push(u, v);
+            }
+        }
+    }
+
+    int edges() const { return edgeCount; }
+    float error() const { return static_cast<float>(worstRadius); }
+
+    // Collapse until at most targetEdges remain (or nothing is left to collapse)
+    void collapseTo(int targetEdges) {
+        std::vector<double> merged(n);
+        while (edgeCount > targetEdges && !heap.empty()) {
+            Candidate top = heap.top();
+            heap.pop();
+            if (!alive[top.u] || !alive[top.v] || stamps[top.u] != top.stampU || stamps[top.v] != top.stampV) continue;
+
+            int u = top.u, v = top.v;
+            bestPosition(u, v, merged.data());
+            // The error is exact: the farthest original vertex of the merged cluster from its new position
+            members[u].insert(members[u].end(), members[v].begin(), members[v].end());
+            members[v].clear();
+            members[v].shrink_to_fit();
+            for (int original : members[u]) worstRadius = std::max(worstRadius, distance(&originals[static_cast<size_t>(original) * n], merged.data()));
+            std::copy(merged.begin(), merged.end(), positions.begin() + static_cast<size_t>(u) * n);
+            quadrics[u].add(quadrics[v]);
+            alive[v] = 0;
+            stamps[u]++;
+
+            // Move v's edges to u, dropping u-v itself and any that u already has
+            removeNeighbor(u, v);
+            edgeCount--;
+            for (int w : neighbors[v]) {
+                if (w == u) continue;
+                removeNeighbor(w, v);
+                if (std::find(neighbors[u].begin(), neighbors[u].end(), w) != neighbors[u].end()) {
+                    edgeCount--;
+                } else {
+                    neighbors[u].push_back(w);
+                    neighbors[w].push_back(u);
+                }
+            }
+            neighbors[v].clear();
+            for (int w : neighbors[u]) push(u, w);
+        }
+    }
+
+    // The surviving vertices and edges as a polytope
+    Polytope snapshot() const {
+        int count = static_cast<int>(alive.size());
+        std::vector<int> remap(count, -1);
+        int live = 0;
+        for (int v = 0; v < count; ++v) {
+            if (alive[v]) remap[v] = live++;
+        }
+
+        Polytope p;
+        p.resize(n, live);
+        for (int v = 0; v < count; ++v) {
+            if (!alive[v]) continue;
+            for (int d = 0; d < n; ++d) p.axis(d)[remap[v]] = static_cast<float>(positions[static_cast<size_t>(v) * n + d]);
+        }
+        p.edges.reserve(edgeCount);
+        for (int u = 0; u < count; ++u) {
+            for (int v : neighbors[u]) {
+                if (u < v) p.edges.emplace_back(remap[u], remap[v]);
+            }
+        }
+        return p;
+    }
+
+private:
+    struct Candidate {
+        double cost;
+        int u, v;
+        uint32_t stampU, stampV;
+        bool operator<(const Candidate& other) const { return cost > other.cost; } // min-heap
+    };
+
+    const double* position(int v) const { return &positions[static_cast<size_t>(v) * n]; }
+
+    double distance(const double* p, const double* q) const {
+        double sum = 0;
+        for (int i = 0; i < n; ++i) sum += (p[i] - q[i]) * (p[i] - q[i]);
+        return std::sqrt(sum);
+    }
+
+    bool unitDirection(int u, int v, double* d) const {
+        double length = 0;
+        for (int i = 0; i < n; ++i) {
+            d[i] = position(v)[i] - position(u)[i];
+            length += d[i] * d[i];
+        }
+        if (length == 0) return false;
+        length = std::sqrt(length);
+        for (int i = 0; i < n; ++i) d[i] /= length;
+        return true;
+    }
+
+    // Lowest-cost of u, v and their midpoint under the summed quadric
+    double bestPosition(int u, int v, double* out) const {
+        EdgeQuadric q = quadrics[u];
+        q.add(quadrics[v]);
+        std::vector<double> mid(n);
+        for (int i = 0; i < n; ++i) mid[i] = 0.5 * (position(u)[i] + position(v)[i]);
+
+        const double* options[3] = {mid.data(), position(u), position(v)};
+        double best = 0;
+        int pick = -1;
+        for (int k = 0; k < 3; ++k) {
+            double cost = q.evaluate(options[k]);
+            if (pick < 0 || cost < best) {
+                best = cost;
+                pick = k;
+            }
+        }
+        if (out) std::copy(options[pick], options[pick] + n, out);
+        return best;
+    }
+
+    void push(int u, int v) { heap.push(Candidate{bestPosition(u, v, nullptr), u, v, stamps[u], stamps[v]}); }
+
+    void removeNeighbor(int from, int v) {
+        auto& list = neighbors[from];
+        list.erase(std::remove(list.begin(), list.end(), v), list.end());
+    }
+
+    int n;
+    std::vector<double> positions; // vertex-major, n per vertex
+    std::vector<EdgeQuadric> quadrics;
+    std::vector<std::vector<int>> neighbors;
+    std::vector<uint32_t> stamps;  // bumped when a vertex moves, so queued candidates can go stale
+    std::vector<uint8_t> alive;
+    std::vector<double> originals; // the input positions, vertex-major
+    std::vector<std::vector<int>> members; // original vertices merged into each live vertex
+    std::priority_queue<Candidate> heap;
+    int edgeCount = 0;
+    double worstRadius = 0;
+};
+
+// Level 0 is the polytope itself; each further level keeps about LOD_LEVEL_RATIO of the edges
+inline std::vector<LodLevel> buildLodChain(const Polytope& base) {
+    std::vector<LodLevel> chain;
+    chain.push_back(LodLevel{base, 0.0f});
+
+    EdgeCollapser collapser(base);
+    int target = static_cast<int>(collapser.edges() * LOD_LEVEL_RATIO);
+    while (static_cast<int>(chain.size()) < LOD_MAX_LEVELS && target >= LOD_MIN_EDGES) {
+        collapser.collapseTo(target);
+        if (collapser.edges() >= static_cast<int>(chain.back().mesh.edges.size())) break;
+        chain.push_back(LodLevel{collapser.snapshot(), collapser.error()});
+        target = static_cast<int>(collapser.edges() * LOD_LEVEL_RATIO);
+    }
+    return chain;
+}
+
+// Runtime pick of a level from the on-screen size of one model unit. A level is good enough
+// when its error covers at most errorPixels on screen. Switching to a coarser level needs
+// its error to fit with HYSTERESIS to spare, so an object hovering at a boundary does not pop.
+class LodSelector {
+public:
+    static constexpr float HYSTERESIS = 0.7f;
+
+    int select(const std::vector<LodLevel>& chain, float pixelsPerUnit, float errorPixels = 1.0f) {
+        int last = static_cast<int>(chain.size()) - 1;
+        current = std::min(current, last);
+
+        // Finer while the current level shows too much error
+        while (current > 0 && chain[current].error * pixelsPerUnit > errorPixels) current--;
+        // Coarser while the next level fits comfortably
+        while (current < last && chain[current + 1].error * pixelsPerUnit <= errorPixels * HYSTERESIS) current++;
+        return current;
+    }
+
+    int level() const { return current; }
+    void reset() { current = 0; }
+
+private:
+    int current = 0;
+};
@@ -1,5 +1,10 @@
 #define SDL_MAIN_HANDLED
 #include "screen.h"
+#include "fastTrig.h"
+#include "resolution.h"
+#include "pointCloud.h"
+#include <chrono>
+#include <cstdio>
 #include <numeric>
 
 
@@ -12,30 +17,32 @@ struct connection{
 };
 
 void rotate(vec3& point, float x = 1, float y=1, float z=1){
-    float rad_x = x;
-    float rad_y = y;
-    float rad_z = z;
+    // One sine/cosine pair per axis instead of a std::sin/std::cos call per use
+    float sin_x, cos_x, sin_y, cos_y, sin_z, cos_z;
+    sinCos(x, sin_x, cos_x);
+    sinCos(y, sin_y, cos_y);
+    sinCos(z, sin_z, cos_z);
 
     // Copy the original values to avoid overwriting
     float tempY, tempZ, tempX;
 
     // Rotate around x-axis
-    tempY = std::cos(rad_x) * point.y - std::sin(rad_x) * point.z;
-    tempZ = std::sin(rad_x) * point.y + std::cos(rad_x) * point.z;
+    tempY = cos_x * point.y - sin_x * point.z;
+    tempZ = sin_x * point.y + cos_x * point.z;
 
     point.y = tempY;
     point.z = tempZ;
 
     // Rotate around y-axis
-    tempX = std::cos(rad_y) * point.x + std::sin(rad_y) * point.z;
-    tempZ = -std::sin(rad_y) * point.x + std::cos(rad_y) * point.z;
+    tempX = cos_y * point.x + sin_y * point.z;
+    tempZ = -sin_y * point.x + cos_y * point.z;
 
     point.x = tempX;
     point.z = tempZ;
 
     // Rotate around z-axis
-    tempX = std::cos(rad_z) * point.x - std::sin(rad_z) * point.y;
-    tempY = std::sin(rad_z) * point.x + std::cos(rad_z) * point.y;
+    tempX = cos_z * point.x - sin_z * point.y;
+    tempY = sin_z * point.x + cos_z * point.y;
 
     point.x = tempX;
     point.y = tempY;
@@ -49,17 +56,79 @@ void line(Screen& screen, float x1, float y1, float x2, float y2){
 
     float length = std::sqrt(dx*dx + dy*dy);
     float angle = std::atan2(dy, dx);
+    float sin_a, cos_a;
+    sinCos(angle, sin_a, cos_a);
 
     for (float i = 0; i < length; i ++){
         screen.pixel(
-            x1+std::cos(angle)*i, 
-            y1+std::sin(angle)*i);
+            x1+cos_a*i, 
+            y1+sin_a*i);
 
     }
 }
 
-int main(){
+// Reads "x y z" per line (anything after the third number is ignored) into points
+bool readPointText(const std::string& path, std::vector<PointRecord>& points){
+    FILE* in = std::fopen(path.c_str(), "r");
+    if (!in) return false;
+    char text[512];
+    while (std::fgets(text, sizeof(text), in)) {
+        PointRecord p{0, 0, 0, 0xFFFFFFFF};
+        if (std::sscanf(text, "%f %f %f", &p.x, &p.y, &p.z) == 3) points.push_back(p);
+    }
+    std::fclose(in);
+    return true;
+}
+
+// Orbits a point cloud file. A .pcoc octree is streamed as is; any other file is read as
+// "x y z" text and converted to <file>.pcoc first.
+int viewPointCloud(Screen& screen, std::string path){
+    if (path.size() < 5 || path.compare(path.size() - 5, 5, ".pcoc") != 0) {
+        std::vector<PointRecord> points;
+        if (!readPointText(path, points)) {
+            std::cerr << "Cannot read " << path << std::endl;
+            return 1;
+        }
+        path += ".pcoc";
+        if (!writePointCloud(path, points)) {
+            std::cerr << "Cannot write " << path << std::endl;
+            return 1;
+        }
+    }
+
+    PointCloudStream cloud;
+    if (!cloud.open(path)) {
+        std::cerr << "Not a point cloud file: " << path << std::endl;
+        return 1;
+    }
+    cloud.pointBudget = 2000000;
+    screen.setBinCount(workerCount());
+    screen.setDeduplicate(true); // far more points than pixels
+
+    PointCloudView view;
+    view.target = cloud.center();
+    view.width = LOGICAL_WIDTH;
+    view.height = LOGICAL_HEIGHT;
+    view.camera = Camera3D::perspective(60, LOGICAL_WIDTH / 2.0f, cloud.radius() * 2, LOGICAL_WIDTH, LOGICAL_HEIGHT);
+
+    float angle = 0;
+    while(true){
+        angle += 0.005f;
+        view.rotation = (angleAxis(-0.5f, Vec3{1, 0, 0}) * angleAxis(angle, Vec3{0, 1, 0})).toMatrix();
+        // Each worker projects its share of the points into its own bin
+        cloud.drawParallel(view, screen.binCount(), [&](int bin, float x, float y, uint32_t color) { screen.bin(bin).pixel(x, y, color); });
+
+        screen.show();
+        screen.clear();
+        screen.input();
+        SDL_Delay(3);
+    }
+    return 0;
+}
+
+int main(int argc, char** argv){
     Screen screen;
+    if (argc > 1) return viewPointCloud(screen, argv[1]);
 
     std::vector<vec3> points {
         {173, 173, 173},
@@ -110,7 +179,21 @@ int main(){
 
 
 
+    // Frame budget: 60 fps, measured as render time before the delay. The demo has no optional
+    // features for a quality governor to switch off, so the resolution alone holds the budget.
+    constexpr float FRAME_BUDGET_MS = 1000.0f / 60;
+
+    // The internal resolution follows the frame time, between a quarter and half of the window
+    // (half is the 640x480 the demo always drew at)
+    ResolutionController resolution(FRAME_BUDGET_MS, 0.25f, 0.5f);
+
+    // Lines step at sub-pixel spacing and corners are shared by three edges, so most points
+    // repeat a pixel; the window title shows how many submissions each drawn pixel took
+    screen.setDeduplicate(true);
+    int frame = 0;
+
     while(true){
+        auto frameStart = std::chrono::high_resolution_clock::now();
         for(auto& p: points) {
             p.x -= c.x;
             p.y -= c.y;
@@ -133,6 +216,11 @@ int main(){
    
         screen.show();
         screen.clear(); 
+        if (++frame % 30 == 0) screen.setTitle("overdraw " + std::to_string(screen.stats().overdraw()));
+
+        auto frameEnd = std::chrono::high_resolution_clock::now();
+        resolution.update(std::chrono::duration<float, std::milli>(frameEnd - frameStart).count());
+        screen.setRenderSize(resolution.size(LOGICAL_WIDTH * WINDOW_SCALE), resolution.size(LOGICAL_HEIGHT * WINDOW_SCALE));
         screen.input();
         SDL_Delay(3);
     }
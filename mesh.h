@@ -0,0 +1,212 @@
+#pragma once
+#include "vec.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Quad face, vertex indices in winding order
+struct Face {
+    int a, b, c, d;
+};
+
+// Find the square faces of an axis-aligned hypercube from its vertex coordinates.
+// Each face spans two axes and holds the other coordinates fixed.
+inline std::vector<Face> buildHypercubeFaces(const std::vector<Vec4>& vertices) {
+    auto coord = [](const Vec4& v, int axis) {
+        return axis == 0 ? v.x : axis == 1 ? v.y : axis == 2 ? v.z : v.w;
+    };
+
+    // Index of the vertex matching v with the given axes mirrored, -1 if there is none
+    auto mirrored = [&](const Vec4& v, int i, int j) {
+        for (size_t k = 0; k < vertices.size(); ++k) {
+            bool match = true;
+            for (int axis = 0; axis < 4 && match; ++axis) {
+                float expected = (axis == i || axis == j) ? -coord(v, axis) : coord(v, axis);
+                match = coord(vertices[k], axis) == expected;
+            }
+            if (match) return static_cast<int>(k);
+        }
+        return -1;
+    };
+
+    std::vector<Face> faces;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = i + 1; j < 4; ++j) {
+            // Start every face from its corner that is negative on both spanning axes
+            for (size_t k = 0; k < vertices.size(); ++k) {
+                const Vec4& v = vertices[k];
+                if (coord(v, i) >= 0 || coord(v, j) >= 0) continue;
+                Face f{static_cast<int>(k), mirrored(v, i, -1), mirrored(v, i, j), mirrored(v, j, -1)};
+                if (f.b >= 0 && f.c >= 0 && f.d >= 0) faces.push_back(f);
+            }
+        }
+    }
+    return faces;
+}
+
+// Faces touching each edge, built once when the mesh is loaded.
+// Faces of edge e are faces[offsets[e]] .. faces[offsets[e + 1] - 1]. A hypercube edge has one
+// face per remaining axis, so the count is not fixed at two.
+struct EdgeAdjacency {
+    std::vector<int> offsets;
+    std::vector<int> faces;
+};
+
+inline EdgeAdjacency buildEdgeAdjacency(const std::vector<std::pair<int, int>>& edges, const std::vector<Face>& faces) {
+    std::unordered_map<uint64_t, int> edgeIndex;
+    auto key = [](int a, int b) {
+        if (a > b) std::swap(a, b);
+        return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+    };
+    for (size_t e = 0; e < edges.size(); ++e) edgeIndex[key(edges[e].first, edges[e].second)] = static_cast<int>(e);
+
+    // Count, then fill, so the result is two flat arrays
+    EdgeAdjacency adjacency;
+    adjacency.offsets.assign(edges.size() + 1, 0);
+    auto forEachFaceEdge = [&](auto&& fn) {
+        for (size_t f = 0; f < faces.size(); ++f) {
+            const int v[4] = {faces[f].a, faces[f].b, faces[f].c, faces[f].d};
+            for (int k = 0; k < 4; ++k) {
+                auto it = edgeIndex.find(key(v[k], v[(k + 1) % 4]));
+                if (it != edgeIndex.end()) fn(it->second, static_cast<int>(f));
+            }
+        }
+    };
+    forEachFaceEdge([&](int e, int) { adjacency.offsets[e + 1]++; });
+    for (size_t e = 0; e < edges.size(); ++e) adjacency.offsets[e + 1] += adjacency.offsets[e];
+
+    adjacency.faces.resize(adjacency.offsets.back());
+    std::vector<int> fill(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+    forEachFaceEdge([&](int e, int f) { adjacency.faces[fill[e]++] = f; });
+    return adjacency;
+}
+
+// Quad normal from its diagonals, which also works for slightly non-planar quads
+inline Vec3 faceNormal(const Face& f, const std::vector<Vec3>& positions) {
+    return cross(positions[f.c] - positions[f.a], positions[f.d] - positions[f.b]);
+}
+
+// Flip faces of a convex mesh so their normals point away from its centroid
+inline void orientFacesOutward(std::vector<Face>& faces, const std::vector<Vec3>& positions) {
+    Vec3 centroid{0, 0, 0};
+    for (const auto& p : positions) centroid = centroid + p;
+    centroid = centroid * (1.0f / positions.size());
+
+    for (auto& f : faces) {
+        Vec3 center = (positions[f.a] + positions[f.b] + positions[f.c] + positions[f.d]) * 0.25f;
+        if (dot(faceNormal(f, positions), center - centroid) < 0) std::swap(f.b, f.d);
+    }
+}
+
+enum class EdgeMode { All, FrontFaces, Silhouette };
+
+// Per-face facing for view-space positions with the camera at the origin:
+// 1 front, -1 back, 0 for faces that collapsed to a line or point
+inline void classifyFaces(const std::vector<Face>& faces, const std::vector<Vec3>& viewPositions, std::vector<int8_t>& facing) {
+    facing.resize(faces.size());
+    for (size_t f = 0; f < faces.size(); ++f) {
+        const Face& face = faces[f];
+        Vec3 d0 = viewPositions[face.c] - viewPositions[face.a];
+        Vec3 d1 = viewPositions[face.d] - viewPositions[face.b];
+        Vec3 n = cross(d0, d1);
+        if (dot(n, n) <= 1e-12f * dot(d0, d0) * dot(d1, d1)) {
+            facing[f] = 0;
+        } else {
+            facing[f] = dot(n, viewPositions[face.a]) < 0 ? 1 : -1;
+        }
+    }
+}
+
+// Whether edge e is drawn in the given mode. FrontFaces keeps edges touching a front face,
+// Silhouette keeps edges between a front face and a back face.
+inline bool edgeVisible(EdgeMode mode, int e, const EdgeAdjacency& adjacency, const std::vector<int8_t>& facing) {
+    if (mode == EdgeMode::All) return true;
+
+    bool front = false, back = false;
+    for (int i = adjacency.offsets[e]; i < adjacency.offsets[e + 1]; ++i) {
+        front |= facing[adjacency.faces[i]] > 0;
+        back |= facing[adjacency.faces[i]] < 0;
+    }
+    return mode == EdgeMode::FrontFaces ? front : (front && back);
+}
+
+// Edges grouped into runs of one color, built once when the mesh is loaded, so drawing sets the
+// color once per run instead of once per edge. Run r draws edges[order[offsets[r]]] ..
+// edges[order[offsets[r + 1] - 1]] in colors[r]. Within a run, edges are chained so that
+// consecutive edges share a vertex where possible and can go out as one polyline.
+struct EdgeColorRuns {
+    std::vector<uint32_t> colors;
+    std::vector<int> order;
+    std::vector<int> offsets;
+};
+
+// Edge color = per-channel average of its two ARGB vertex colors
+inline EdgeColorRuns buildEdgeColorRuns(const std::vector<std::pair<int, int>>& edges, const std::vector<uint32_t>& vertexColors) {
+    auto average = [](uint32_t a, uint32_t b) {
+        uint32_t c = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            c |= ((((a >> shift) & 0xFF) + ((b >> shift) & 0xFF)) / 2) << shift;
+        }
+        return c;
+    };
+
+    std::vector<uint32_t> edgeColors(edges.size());
+    std::vector<int> sorted(edges.size());
+    for (size_t e = 0; e < edges.size(); ++e) {
+        edgeColors[e] = average(vertexColors[edges[e].first], vertexColors[edges[e].second]);
+        sorted[e] = static_cast<int>(e);
+    }
+    std::stable_sort(sorted.begin(), sorted.end(), [&](int a, int b) { return edgeColors[a] < edgeColors[b]; });
+
+    EdgeColorRuns runs;
+    runs.order.reserve(edges.size());
+    std::vector<bool> used(edges.size(), false);
+
+    // Per run: the run's (vertex, edge) pairs sorted by vertex, and for each vertex a cursor to
+    // its first pair that may still be unused. Finding the next edge at a vertex pops from there,
+    // so chaining a run costs its sort instead of a rescan of the run per edge.
+    std::vector<std::pair<int, int>> incident;
+    std::vector<size_t> cursor(vertexColors.size());
+    auto nextEdge = [&](int vertex) {
+        for (size_t& k = cursor[vertex]; k < incident.size() && incident[k].first == vertex; ++k) {
+            if (!used[incident[k].second]) return incident[k++].second;
+        }
+        return -1;
+    };
+
+    for (size_t begin = 0; begin < sorted.size();) {
+        size_t end = begin;
+        while (end < sorted.size() && edgeColors[sorted[end]] == edgeColors[sorted[begin]]) end++;
+
+        runs.colors.push_back(edgeColors[sorted[begin]]);
+        runs.offsets.push_back(static_cast<int>(runs.order.size()));
+
+        // Pairs keep the run's order per vertex, so each pop takes the earliest unused edge
+        incident.clear();
+        for (size_t i = begin; i < end; ++i) {
+            incident.emplace_back(edges[sorted[i]].first, static_cast<int>(i - begin));
+            incident.emplace_back(edges[sorted[i]].second, static_cast<int>(i - begin));
+        }
+        std::sort(incident.begin(), incident.end());
+        for (auto& [vertex, edge] : incident) edge = sorted[begin + edge];
+        for (size_t k = incident.size(); k-- > 0;) cursor[incident[k].first] = k;
+
+        // Greedy chaining: keep taking an unused edge that touches the current chain's tail
+        for (size_t i = begin; i < end; ++i) {
+            if (used[sorted[i]]) continue;
+            int e = sorted[i];
+            int tail = edges[e].first; // the chain leaves the first edge through its second vertex
+            while (e >= 0) {
+                used[e] = true;
+                runs.order.push_back(e);
+                tail = edges[e].first == tail ? edges[e].second : edges[e].first;
+                e = nextEdge(tail);
+            }
+        }
+        begin = end;
+    }
+    runs.offsets.push_back(static_cast<int>(runs.order.size()));
+    return runs;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Number of worker threads to use when the caller does not ask for a specific count
+inline int workerCount() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+// Run fn(i) for every i in [0, count), handing out indices to up to threadCount threads.
+// The calling thread takes part in the work, so threadCount == 1 runs everything inline.
+template <typename Fn>
+void parallelFor(int count, Fn&& fn, int threadCount = 0) {
+    if (threadCount <= 0) threadCount = workerCount();
+    threadCount = std::min(threadCount, count);
+
+    if (threadCount <= 1) {
+        for (int i = 0; i < count; ++i) fn(i);
+        return;
+    }
+
+    std::atomic<int> next{0};
+    auto worker = [&]() {
+        for (int i = next++; i < count; i = next++) fn(i);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (int t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+}
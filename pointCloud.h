@@ -0,0 +1,460 @@
+#pragma once
+#include "camera4D.h"
+#include "parallel.h"
+#include "quaternion.h"
+#include "vec.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Out-of-core point clouds: an octree file on disk and a streamer that keeps only the nodes the
+// current view needs in memory.
+//
+// Every octree node stores a spatially even subsample of the points inside its cube (at most
+// one point per cell of a POINT_CLOUD_GRID^3 grid over the cube); the points it did not keep go
+// to its children. Drawing a node and then its children therefore refines the same region, and
+// stopping anywhere still shows the whole cloud at lower density.
+//
+// File layout, host byte order:
+//   PointCloudHeader
+//   PointCloudNode[nodeCount]    node 0 is the root, children of a node are stored consecutively
+//   PointRecord blocks           one per node, at PointCloudNode::offset
+constexpr int POINT_CLOUD_GRID = 32;             // subsample cells per node axis
+constexpr int POINT_CLOUD_MAX_DEPTH = 24;        // deeper nodes keep all their points
+constexpr uint32_t POINT_CLOUD_VERSION = 1;
+
+struct PointRecord {
+    float x, y, z;
+    uint32_t color; // ARGB
+};
+
+struct PointCloudHeader {
+    char magic[4] = {'P', 'C', 'O', 'C'};
+    uint32_t version = POINT_CLOUD_VERSION;
+    uint64_t nodeCount = 0;
+    uint64_t pointCount = 0;
+    float center[3] = {0, 0, 0}; // root cube
+    float halfSize = 0;
+};
+
+struct PointCloudNode {
+    uint64_t offset = 0;    // byte offset of the node's PointRecords in the file
+    uint32_t pointCount = 0;
+    int32_t firstChild = -1;
+    uint8_t childMask = 0;  // bit k set when octant k has a child (x = bit 0, y = bit 1, z = bit 2)
+    uint8_t depth = 0;
+    uint16_t unused = 0;
+    float center[3] = {0, 0, 0};
+    float halfSize = 0;
+};
+
+// Builds the octree file from points held in memory. Returns false if the file cannot be written,
+// or for more than UINT32_MAX points, which the 32-bit point indices of the build cannot address.
+// For clouds larger than memory, build per region and merge the node tables (not done here).
+inline bool writePointCloud(const std::string& path, const std::vector<PointRecord>& points) {
+    if (points.size() > UINT32_MAX) return false;
+    PointCloudHeader header;
+    header.pointCount = points.size();
+    Vec3 lo{INFINITY, INFINITY, INFINITY}, hi{-INFINITY, -INFINITY, -INFINITY};
+    for (const PointRecord& p : points) {
+        lo = minVec(lo, Vec3{p.x, p.y, p.z});
+        hi = maxVec(hi, Vec3{p.x, p.y, p.z});
+    }
+    if (points.empty()) lo = hi = Vec3{0, 0, 0};
+    Vec3 center = (lo + hi) * 0.5f;
+    header.center[0] = center.x;
+    header.center[1] = center.y;
+    header.center[2] = center.z;
+    header.halfSize = std::max({hi.x - lo.x, hi.y - lo.y, hi.z - lo.z}) * 0.5f * 1.001f + 1e-6f;
+
+    // Breadth-first, so each node's children get consecutive indices
+    std::vector<PointCloudNode> nodes(1);
+    std::vector<std::vector<uint32_t>> members(1);
+    std::copy(header.center, header.center + 3, nodes[0].center);
+    nodes[0].halfSize = header.halfSize;
+    members[0].resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i) members[0][i] = static_cast<uint32_t>(i);
+
+    std::vector<std::vector<uint32_t>> kept;
+    std::vector<int32_t> cellOwner(static_cast<size_t>(POINT_CLOUD_GRID) * POINT_CLOUD_GRID * POINT_CLOUD_GRID);
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        std::vector<uint32_t> inside = std::move(members[n]);
+        PointCloudNode node = nodes[n];
+        float cellSize = 2 * node.halfSize / POINT_CLOUD_GRID;
+        auto cellOf = [&](const PointRecord& p, int axis) {
+            float coordinate = axis == 0 ? p.x : axis == 1 ? p.y : p.z;
+            int cell = static_cast<int>((coordinate - (node.center[axis] - node.halfSize)) / cellSize);
+            return std::clamp(cell, 0, POINT_CLOUD_GRID - 1);
+        };
+
+        // One point per grid cell stays here, the rest go down by octant. Scans are mostly
+        // surfaces, which fill about GRID^2 cells, so a node that small keeps everything.
+        std::vector<uint32_t> here, octant[8];
+        if (inside.size() <= static_cast<size_t>(POINT_CLOUD_GRID) * POINT_CLOUD_GRID || node.depth >= POINT_CLOUD_MAX_DEPTH) {
+            here = std::move(inside);
+        } else {
+            std::fill(cellOwner.begin(), cellOwner.end(), -1);
+            for (uint32_t i : inside) {
+                const PointRecord& p = points[i];
+                size_t cell = (static_cast<size_t>(cellOf(p, 2)) * POINT_CLOUD_GRID + cellOf(p, 1)) * POINT_CLOUD_GRID + cellOf(p, 0);
+                if (cellOwner[cell] < 0) {
+                    cellOwner[cell] = 0;
+                    here.push_back(i);
+                } else {
+                    int k = (p.x >= node.center[0]) | (p.y >= node.center[1]) << 1 | (p.z >= node.center[2]) << 2;
+                    octant[k].push_back(i);
+                }
+            }
+        }
+
+        nodes[n].pointCount = static_cast<uint32_t>(here.size());
+        kept.push_back(std::move(here));
+        for (int k = 0; k < 8; ++k) {
+            if (octant[k].empty()) continue;
+            if (nodes[n].firstChild < 0) nodes[n].firstChild = static_cast<int32_t>(nodes.size());
+            nodes[n].childMask |= static_cast<uint8_t>(1 << k);
+
+            PointCloudNode child;
+            child.depth = static_cast<uint8_t>(node.depth + 1);
+            child.halfSize = node.halfSize * 0.5f;
+            for (int axis = 0; axis < 3; ++axis) {
+                child.center[axis] = node.center[axis] + ((k >> axis) & 1 ? child.halfSize : -child.halfSize);
+            }
+            nodes.push_back(child);
+            members.push_back(std::move(octant[k]));
+        }
+    }
+
+    header.nodeCount = nodes.size();
+    uint64_t offset = sizeof(PointCloudHeader) + nodes.size() * sizeof(PointCloudNode);
+    for (size_t n = 0; n < nodes.size(); ++n) {
+        nodes[n].offset = offset;
+        offset += static_cast<uint64_t>(nodes[n].pointCount) * sizeof(PointRecord);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(PointCloudNode)));
+    std::vector<PointRecord> block;
+    for (const auto& indices : kept) {
+        block.clear();
+        for (uint32_t i : indices) block.push_back(points[i]);
+        out.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(block.size() * sizeof(PointRecord)));
+    }
+    return static_cast<bool>(out);
+}
+
+// Orbit view: points are taken relative to target, rotated, then projected by camera
+// (whose zOffset is the orbit distance)
+struct PointCloudView {
+    Vec3 target{0, 0, 0};
+    Mat3 rotation{{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}}};
+    Camera3D camera;
+    float width = 0, height = 0; // viewport, for culling
+};
+
+// Streams an octree file. Each frame, draw() walks the octree from the root, largest projected
+// nodes first, and plots the points of every resident node it reaches; nodes that are needed but
+// not resident are queued for the loader thread, and their children wait until they arrive.
+//
+// Frame time is bounded by the point budget and by the walk only ever stepping one level past
+// resident nodes. Memory is bounded by the byte budget: the least recently drawn nodes are evicted
+// first, nodes drawn in the last two frames never, and a load that cannot make room is dropped
+// (nodes that would not fit are not requested until room can be made).
+class PointCloudStream {
+public:
+    size_t memoryBudget = size_t(256) << 20; // bytes of resident point data
+    size_t pointBudget = 1000000;            // points drawn per frame
+    float spacingPixels = 1.0f;              // refine while a node's grid cell projects larger than this
+
+    PointCloudStream() = default;
+    PointCloudStream(const PointCloudStream&) = delete;
+    PointCloudStream& operator=(const PointCloudStream&) = delete;
+    ~PointCloudStream() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+        file.open(path, std::ios::binary);
+        if (!file) return false;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!file || std::memcmp(header.magic, "PCOC", 4) != 0 || header.version != POINT_CLOUD_VERSION || header.nodeCount == 0) {
+            file.close();
+            return false;
+        }
+        nodes.resize(header.nodeCount);
+        file.read(reinterpret_cast<char*>(nodes.data()), static_cast<std::streamsize>(nodes.size() * sizeof(PointCloudNode)));
+        if (!file) {
+            file.close();
+            return false;
+        }
+        state.assign(nodes.size(), NodeState{});
+        requested.assign(nodes.size(), 0);
+
+        stopping = false;
+        loader = std::thread([this] { loadLoop(); });
+        return true;
+    }
+
+    void close() {
+        if (loader.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_one();
+            loader.join();
+        }
+        file.close();
+        nodes.clear();
+        state.clear();
+        requested.clear();
+        lru.clear();
+        requests.clear();
+        completed.clear();
+        residentBytes = 0;
+    }
+
+    const PointCloudHeader& info() const { return header; }
+    size_t bytesResident() const { return residentBytes; }
+    size_t nodesResident() const { return lru.size(); }
+    size_t pointsDrawn() const { return drawnPoints; }
+
+    // Center and radius of the whole cloud, for framing a view
+    Vec3 center() const { return Vec3{header.center[0], header.center[1], header.center[2]}; }
+    float radius() const { return header.halfSize * std::sqrt(3.0f); }
+
+    // Plots the visible points of this frame with plot(screenX, screenY, color)
+    template <typename Plot>
+    void draw(const PointCloudView& view, Plot&& plot) {
+        drawParallel(view, 1, [&](int, float x, float y, uint32_t color) { plot(x, y, color); });
+    }
+
+    // Same, with the projection split over binCount threads: plot(bin, screenX, screenY, color)
+    // is called from one thread per bin at a time, so per-bin output needs no locking
+    template <typename Plot>
+    void drawParallel(const PointCloudView& view, int binCount, Plot&& plot) {
+        if (nodes.empty()) return;
+        frame++;
+        integrateLoads();
+
+        // Largest projected node first, so the point budget goes to what covers the most screen
+        wanted.clear();
+        frontier.clear();
+        drawList.clear();
+        drawnPoints = 0;
+        float size;
+        if (visible(view, 0, size)) pushFrontier(0, size);
+        while (!frontier.empty() && drawnPoints < pointBudget) {
+            std::pop_heap(frontier.begin(), frontier.end());
+            auto [nodeSize, n] = frontier.back();
+            frontier.pop_back();
+
+            NodeState& s = state[n];
+            if (!s.resident) {
+                wanted.emplace_back(nodeSize, n);
+                continue;
+            }
+            s.lastUsed = frame;
+            lru.splice(lru.end(), lru, s.lruPosition);
+
+            size_t count = std::min(s.points.size(), pointBudget - drawnPoints);
+            drawList.push_back(DrawRange{n, drawnPoints});
+            drawnPoints += count;
+
+            // Children only while this node's points are still spread wider than spacingPixels
+            if (nodeSize / POINT_CLOUD_GRID <= spacingPixels) continue;
+            const PointCloudNode& node = nodes[n];
+            int child = node.firstChild;
+            for (int k = 0; k < 8; ++k) {
+                if (!(node.childMask & (1 << k))) continue;
+                if (visible(view, child, size)) pushFrontier(child, size);
+                child++;
+            }
+        }
+        postRequests();
+        if (drawList.empty()) return;
+
+        // Each bin projects an equal share of the points, which may start or end inside a node
+        binCount = std::max(1, std::min(binCount, static_cast<int>(drawnPoints / MIN_POINTS_PER_BIN) + 1));
+        parallelFor(binCount, [&](int bin) {
+            size_t first = drawnPoints * bin / binCount, last = drawnPoints * (bin + 1) / binCount;
+            auto range = std::upper_bound(drawList.begin(), drawList.end(), first,
+                                          [](size_t point, const DrawRange& r) { return point < r.firstPoint; }) - 1;
+            for (; range != drawList.end() && range->firstPoint < last; ++range) {
+                const std::vector<PointRecord>& points = state[range->node].points;
+                size_t begin = std::max(first, range->firstPoint) - range->firstPoint;
+                size_t end = std::min(last - range->firstPoint, points.size());
+                for (size_t i = begin; i < end; ++i) {
+                    const PointRecord& p = points[i];
+                    Vec3 v = view.rotation * Vec3{p.x - view.target.x, p.y - view.target.y, p.z - view.target.z};
+                    Vec3 onScreen = view.camera.project(v.x, v.y, v.z);
+                    if (onScreen.z > 0) plot(bin, onScreen.x, onScreen.y, p.color);
+                }
+            }
+        }, binCount);
+    }
+
+private:
+    static constexpr size_t MIN_POINTS_PER_BIN = 16384; // smaller shares are not worth a thread
+
+    // Points drawList entries [firstPoint, next entry's firstPoint) come from node
+    struct DrawRange {
+        uint32_t node;
+        size_t firstPoint;
+    };
+
+    struct NodeState {
+        bool resident = false;
+        uint64_t lastUsed = 0; // frame the node was last drawn in
+        std::list<uint32_t>::iterator lruPosition;
+        std::vector<PointRecord> points;
+    };
+
+    void pushFrontier(uint32_t n, float size) {
+        frontier.emplace_back(size, n);
+        std::push_heap(frontier.begin(), frontier.end());
+    }
+
+    // Projected diameter of the node's cube in pixels, false when it is off screen
+    bool visible(const PointCloudView& view, uint32_t n, float& size) const {
+        const PointCloudNode& node = nodes[n];
+        float radius = node.halfSize * 1.7320508f;
+        Vec3 c = view.rotation * Vec3{node.center[0] - view.target.x, node.center[1] - view.target.y, node.center[2] - view.target.z};
+        float depth = c.z + view.camera.zOffset;
+        if (depth + radius <= 0) return false;
+        if (depth <= radius) {
+            size = INFINITY; // the eye is inside or next to the node
+            return true;
+        }
+        Vec3 s = view.camera.project(c.x, c.y, c.z);
+        float rx = radius * view.camera.focalX / depth, ry = radius * view.camera.focalY / depth;
+        if (s.x + rx < 0 || s.y + ry < 0 || s.x - rx > view.width || s.y - ry > view.height) return false;
+        size = 2 * std::max(rx, ry);
+        return true;
+    }
+
+    size_t nodeBytes(uint32_t n) const { return static_cast<size_t>(nodes[n].pointCount) * sizeof(PointRecord); }
+
+    // Bytes a load could take now: the free budget plus the nodes integrateLoads may evict (least
+    // recently drawn, not drawn in the last two frames), counted only until they cover wantedBytes
+    size_t availableBytes(size_t wantedBytes) const {
+        size_t available = memoryBudget > residentBytes ? memoryBudget - residentBytes : 0;
+        for (auto it = lru.begin(); it != lru.end() && available < wantedBytes && state[*it].lastUsed + 1 < frame; ++it) {
+            available += state[*it].points.size() * sizeof(PointRecord);
+        }
+        return available;
+    }
+
+    // Replace the loader's queue with this frame's wants, largest first. Nodes that cannot fit in
+    // the budget are not requested: integrateLoads would drop them, and the next frame would read
+    // them from disk again. They are asked for once drawing elsewhere lets resident nodes go.
+    void postRequests() {
+        std::sort(wanted.begin(), wanted.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+        size_t largest = 0;
+        for (const auto& want : wanted) largest = std::max(largest, nodeBytes(want.second));
+        size_t available = availableBytes(largest);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (uint32_t n : requests) requested[n] = 0;
+            requests.clear();
+            for (const auto& want : wanted) {
+                uint32_t n = want.second;
+                if (requested[n] || static_cast<int64_t>(n) == loading || nodeBytes(n) > available) continue;
+                requested[n] = 1;
+                requests.push_back(n);
+            }
+        }
+        if (!wanted.empty()) wake.notify_one();
+    }
+
+    // Move finished loads into the cache, evicting least recently drawn nodes to stay in budget
+    void integrateLoads() {
+        std::vector<std::pair<uint32_t, std::vector<PointRecord>>> arrived;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            arrived.swap(completed);
+        }
+        for (auto& [n, points] : arrived) {
+            if (state[n].resident) continue;
+            size_t bytes = points.size() * sizeof(PointRecord);
+            while (residentBytes + bytes > memoryBudget && !lru.empty() && state[lru.front()].lastUsed + 1 < frame) evict(lru.front());
+            if (residentBytes + bytes > memoryBudget) continue; // everything resident is in use, drop it
+
+            NodeState& s = state[n];
+            s.resident = true;
+            s.lastUsed = frame;
+            s.lruPosition = lru.insert(lru.end(), n);
+            residentBytes += bytes;
+            s.points = std::move(points);
+        }
+    }
+
+    void evict(uint32_t n) {
+        NodeState& s = state[n];
+        lru.erase(s.lruPosition);
+        residentBytes -= s.points.size() * sizeof(PointRecord);
+        s.points = std::vector<PointRecord>();
+        s.resident = false;
+    }
+
+    // Background thread: read the most wanted node, hand it back, repeat
+    void loadLoop() {
+        std::vector<PointRecord> block;
+        for (;;) {
+            uint32_t n;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !requests.empty(); });
+                if (stopping) return;
+                n = requests.front();
+                requests.erase(requests.begin());
+                requested[n] = 0;
+                loading = n;
+            }
+
+            const PointCloudNode& node = nodes[n];
+            block.resize(node.pointCount);
+            file.seekg(static_cast<std::streamoff>(node.offset));
+            file.read(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(block.size() * sizeof(PointRecord)));
+            bool ok = static_cast<bool>(file);
+            file.clear();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            loading = -1;
+            if (ok) completed.emplace_back(n, block);
+        }
+    }
+
+    PointCloudHeader header;
+    std::vector<PointCloudNode> nodes;
+    std::ifstream file;                  // read by the loader thread only once it runs
+
+    // Main thread
+    std::vector<NodeState> state;
+    std::list<uint32_t> lru;             // least recently drawn at the front
+    size_t residentBytes = 0;
+    uint64_t frame = 1;
+    size_t drawnPoints = 0;
+    std::vector<std::pair<float, uint32_t>> frontier, wanted;
+    std::vector<DrawRange> drawList;
+
+    // Shared with the loader thread
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<uint32_t> requests;      // most wanted first
+    std::vector<uint8_t> requested;      // per node, set while queued in requests
+    int64_t loading = -1;                // node the loader is reading right now
+    std::vector<std::pair<uint32_t, std::vector<PointRecord>>> completed;
+    bool stopping = false;
+    std::thread loader;
+};
@@ -0,0 +1,142 @@
+#pragma once
+#include "fastTrig.h"
+#include "vec.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+constexpr int MAX_POLYTOPE_DIMENSION = 12;
+
+// N-dimensional polytope with its vertices in structure-of-arrays form:
+// coordinate d of vertex i is coords[d * count + i]. A plane rotation then walks two
+// contiguous rows, which the compiler vectorizes.
+struct Polytope {
+    int dimension = 0;
+    int count = 0;
+    std::vector<float> coords;
+    std::vector<std::pair<int, int>> edges;
+
+    float* axis(int d) { return &coords[static_cast<size_t>(d) * count]; }
+    const float* axis(int d) const { return &coords[static_cast<size_t>(d) * count]; }
+
+    void resize(int n, int vertexCount) {
+        dimension = n;
+        count = vertexCount;
+        coords.assign(static_cast<size_t>(n) * vertexCount, 0.0f);
+    }
+
+    // Scale about the origin so the farthest vertex sits at the given radius
+    void normalizeRadius(float radius = 1.0f) {
+        float farthest = 0;
+        for (int i = 0; i < count; ++i) {
+            float r = 0;
+            for (int d = 0; d < dimension; ++d) r += axis(d)[i] * axis(d)[i];
+            farthest = std::max(farthest, r);
+        }
+        if (farthest == 0) return;
+        float s = radius / std::sqrt(farthest);
+        for (float& c : coords) c *= s;
+    }
+};
+
+// 2^n vertices at the corners of [-1, 1]^n, joined when they differ in one coordinate
+inline Polytope makeHypercube(int n) {
+    Polytope p;
+    p.resize(n, 1 << n);
+    for (int d = 0; d < n; ++d) {
+        float* row = p.axis(d);
+        for (int i = 0; i < p.count; ++i) row[i] = (i >> d) & 1 ? 1.0f : -1.0f;
+    }
+    p.edges.reserve(static_cast<size_t>(n) << (n - 1));
+    for (int i = 0; i < p.count; ++i) {
+        for (int d = 0; d < n; ++d) {
+            int j = i ^ (1 << d);
+            if (i < j) p.edges.emplace_back(i, j);
+        }
+    }
+    p.normalizeRadius();
+    return p;
+}
+
+// n + 1 equidistant vertices, every pair joined
+inline Polytope makeSimplex(int n) {
+    Polytope p;
+    p.resize(n, n + 1);
+
+    // The n unit vectors plus a point on the diagonal at the same distance from each of them
+    float diagonal = (1.0f - std::sqrt(static_cast<float>(n + 1))) / n;
+    for (int d = 0; d < n; ++d) {
+        float* row = p.axis(d);
+        row[d] = 1.0f;
+        row[n] = diagonal;
+
+        float centroid = (1.0f + diagonal) / (n + 1);
+        for (int i = 0; i <= n; ++i) row[i] -= centroid;
+    }
+    for (int i = 0; i <= n; ++i) {
+        for (int j = i + 1; j <= n; ++j) p.edges.emplace_back(i, j);
+    }
+    p.normalizeRadius();
+    return p;
+}
+
+// 2n vertices at +-1 on each axis, joined unless they are opposite
+inline Polytope makeCrossPolytope(int n) {
+    Polytope p;
+    p.resize(n, 2 * n);
+    for (int d = 0; d < n; ++d) {
+        p.axis(d)[2 * d] = 1.0f;
+        p.axis(d)[2 * d + 1] = -1.0f;
+    }
+    for (int i = 0; i < p.count; ++i) {
+        for (int j = i + 1; j < p.count; ++j) {
+            if (j != (i ^ 1)) p.edges.emplace_back(i, j);
+        }
+    }
+    return p;
+}
+
+// Rotation by angle in the plane spanned by axes i and j
+struct PlaneRotation {
+    int i, j;
+    float angle;
+};
+
+// Apply the Givens rotations in order to every vertex, in place
+inline void rotatePlanes(Polytope& p, const std::vector<PlaneRotation>& rotations) {
+    for (const auto& rotation : rotations) {
+        float s, c;
+        sinCos(rotation.angle, s, c);
+        float* a = p.axis(rotation.i);
+        float* b = p.axis(rotation.j);
+        for (int k = 0; k < p.count; ++k) {
+            float x = a[k], y = b[k];
+            a[k] = x * c - y * s;
+            b[k] = x * s + y * c;
+        }
+    }
+}
+
+// Project down to 3D with one perspective divide per extra dimension (N -> N-1 -> ... -> 3).
+// Each step views the highest axis from the given distance; the divides compound into a single
+// per-vertex scale, so no intermediate N-1, N-2, ... dimensional copies are made.
+// The magnification compounds too: for unit-radius polytopes keep distance around 3 or more.
+// The depth of each divide is clamped so vertices near an eye do not blow up.
+inline void projectTo3D(const Polytope& p, float distance, std::vector<Vec3>& out, std::vector<float>& scratch) {
+    float minDepth = 0.25f * distance;
+    scratch.assign(p.count, 1.0f);
+    float* scale = scratch.data();
+    for (int d = p.dimension - 1; d >= 3; --d) {
+        const float* row = p.axis(d);
+        for (int k = 0; k < p.count; ++k) scale[k] *= distance / std::max(distance - row[k] * scale[k], minDepth);
+    }
+
+    out.resize(p.count);
+    const float* x = p.dimension > 0 ? p.axis(0) : nullptr;
+    const float* y = p.dimension > 1 ? p.axis(1) : nullptr;
+    const float* z = p.dimension > 2 ? p.axis(2) : nullptr;
+    for (int k = 0; k < p.count; ++k) {
+        out[k] = Vec3{x ? x[k] * scale[k] : 0.0f, y ? y[k] * scale[k] : 0.0f, z ? z[k] * scale[k] : 0.0f};
+    }
+}
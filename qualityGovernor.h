@@ -0,0 +1,185 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+// Frame stages the governor can see. A frame adds each stage's time with FrameTimer::lap().
+enum class FrameStage { Transform, Faces, Edges, Curves, Present, Count };
+constexpr int FRAME_STAGE_COUNT = static_cast<int>(FrameStage::Count);
+
+inline const char* frameStageName(FrameStage stage) {
+    switch (stage) {
+    case FrameStage::Transform: return "transform";
+    case FrameStage::Faces: return "faces";
+    case FrameStage::Edges: return "edges";
+    case FrameStage::Curves: return "curves";
+    case FrameStage::Present: return "present";
+    default: return "?";
+    }
+}
+
+// Measured time per stage for one frame
+struct FrameTimings {
+    float stageMs[FRAME_STAGE_COUNT] = {};
+    float totalMs = 0;
+
+    float& operator[](FrameStage stage) { return stageMs[static_cast<int>(stage)]; }
+    float operator[](FrameStage stage) const { return stageMs[static_cast<int>(stage)]; }
+};
+
+// Splits one frame into stage times: each lap() charges the time since the previous lap (or
+// begin()) to a stage, so stages that run once per viewport simply add up
+class FrameTimer {
+    using Clock = std::chrono::high_resolution_clock;
+    Clock::time_point frameStart, last;
+
+public:
+    FrameTimings timings;
+
+    void begin() {
+        timings = FrameTimings{};
+        frameStart = last = Clock::now();
+    }
+
+    void lap(FrameStage stage) {
+        Clock::time_point now = Clock::now();
+        timings[stage] += std::chrono::duration<float, std::milli>(now - last).count();
+        last = now;
+    }
+
+    // Time since begin(), also stored as timings.totalMs
+    float end() {
+        timings.totalMs = std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count();
+        return timings.totalMs;
+    }
+};
+
+// Features the governor may switch down, each charged to the stage it costs time in
+enum class QualityKnob { GradientColors, CurveDetail, LevelOfDetail, DepthTest, Count };
+constexpr int QUALITY_KNOB_COUNT = static_cast<int>(QualityKnob::Count);
+
+inline const char* qualityKnobName(QualityKnob knob) {
+    switch (knob) {
+    case QualityKnob::GradientColors: return "gradientColors";
+    case QualityKnob::CurveDetail: return "curveDetail";
+    case QualityKnob::LevelOfDetail: return "levelOfDetail";
+    case QualityKnob::DepthTest: return "depthTest";
+    default: return "?";
+    }
+}
+
+inline FrameStage qualityKnobStage(QualityKnob knob) {
+    switch (knob) {
+    case QualityKnob::GradientColors: return FrameStage::Edges;
+    case QualityKnob::CurveDetail: return FrameStage::Curves;
+    case QualityKnob::LevelOfDetail: return FrameStage::Transform;
+    case QualityKnob::DepthTest: return FrameStage::Faces;
+    default: return FrameStage::Present;
+    }
+}
+
+// Holds a frame-time budget by switching quality features down one at a time when frames overrun
+// and back up when there is headroom.
+//
+// Only knobs the frame actually uses (setActive) are candidates. On a sustained overrun the
+// governor reduces the active knob whose stage took the longest; the last reduced knob is the
+// first restored, after RESTORE_FRAMES frames in a row with headroom. A restore is a probe: if
+// the knob has to be reduced again soon after, the wait before the next restore doubles (up to
+// MAX_RESTORE_FRAMES), so a knob that does not fit stops flipping on and off.
+// Every decision is written to the log stream as one CSV line.
+class QualityGovernor {
+public:
+    static constexpr int DEGRADE_FRAMES = 10;  // overrunning frames in a row before reducing
+    static constexpr int RESTORE_FRAMES = 60;  // frames in a row with headroom before restoring
+    static constexpr int MAX_RESTORE_FRAMES = 60 * 16;
+    static constexpr float HEADROOM = 0.75f;   // "headroom" means under this part of the budget
+
+    explicit QualityGovernor(float budgetMs, std::ostream* log = nullptr) : budget(budgetMs), log(log) {
+        if (log) {
+            *log << "frame,action,knob,totalMs,budgetMs";
+            for (int s = 0; s < FRAME_STAGE_COUNT; ++s) *log << ',' << frameStageName(static_cast<FrameStage>(s)) << "Ms";
+            *log << '\n';
+        }
+    }
+
+    // Whether the frame uses a knob at all (e.g. the user has gradient edges switched on)
+    void setActive(QualityKnob knob, bool active) { knobs[static_cast<int>(knob)].active = active; }
+
+    // True unless the governor has reduced this knob
+    bool enabled(QualityKnob knob) const { return !knobs[static_cast<int>(knob)].reduced; }
+
+    // Feed one frame's timings. canReduce / canRestore let a caller order the governor against
+    // other controls, e.g. only reduce once resolution is already at its minimum.
+    void update(const FrameTimings& timings, bool canReduce = true, bool canRestore = true) {
+        frame++;
+        if (timings.totalMs > budget) {
+            overrunFrames++;
+            headroomFrames = 0;
+        } else {
+            overrunFrames = 0;
+            headroomFrames = timings.totalMs < budget * HEADROOM ? headroomFrames + 1 : 0;
+        }
+
+        if (overrunFrames >= DEGRADE_FRAMES && canReduce) {
+            overrunFrames = 0;
+            int pick = -1;
+            for (int k = 0; k < QUALITY_KNOB_COUNT; ++k) {
+                const Knob& knob = knobs[k];
+                if (!knob.active || knob.reduced) continue;
+                if (pick < 0 || timings[qualityKnobStage(static_cast<QualityKnob>(k))] >
+                                timings[qualityKnobStage(static_cast<QualityKnob>(pick))]) {
+                    pick = k;
+                }
+            }
+            if (pick >= 0) {
+                Knob& knob = knobs[pick];
+                // Reduced again shortly after a restore: that restore did not fit, wait longer next time
+                bool failedProbe = knob.restoredAt > 0 && frame - knob.restoredAt < static_cast<uint64_t>(knob.restoreFrames) * 2;
+                knob.restoreFrames = failedProbe ? std::min(knob.restoreFrames * 2, MAX_RESTORE_FRAMES) : RESTORE_FRAMES;
+                knob.reduced = true;
+                reducedOrder.push_back(pick);
+                record("reduce", pick, timings);
+            }
+        }
+
+        if (canRestore && !reducedOrder.empty()) {
+            int k = reducedOrder.back();
+            if (headroomFrames >= knobs[k].restoreFrames) {
+                headroomFrames = 0;
+                knobs[k].reduced = false;
+                knobs[k].restoredAt = frame;
+                reducedOrder.pop_back();
+                record("restore", k, timings);
+            }
+        }
+    }
+
+    float budgetMs() const { return budget; }
+    int reducedCount() const { return static_cast<int>(reducedOrder.size()); }
+
+private:
+    struct Knob {
+        bool active = false;
+        bool reduced = false;
+        int restoreFrames = RESTORE_FRAMES; // headroom frames needed before the next restore
+        uint64_t restoredAt = 0;
+    };
+
+    void record(const char* action, int knob, const FrameTimings& timings) {
+        if (!log) return;
+        *log << frame << ',' << action << ',' << qualityKnobName(static_cast<QualityKnob>(knob)) << ','
+             << timings.totalMs << ',' << budget;
+        for (int s = 0; s < FRAME_STAGE_COUNT; ++s) *log << ',' << timings.stageMs[s];
+        *log << std::endl;
+    }
+
+    float budget;
+    std::ostream* log;
+    Knob knobs[QUALITY_KNOB_COUNT];
+    std::vector<int> reducedOrder;
+    uint64_t frame = 0;
+    int overrunFrames = 0;
+    int headroomFrames = 0;
+};
@@ -0,0 +1,180 @@
+#pragma once
+#include "fastTrig.h"
+#include "vec.h"
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Row-major 3x3 matrix
+struct Mat3 {
+    float m[3][3];
+
+    Vec3 operator*(const Vec3& v) const {
+        return Vec3{
+            m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+            m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+            m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z
+        };
+    }
+};
+
+// Define a quaternion for rotation
+struct Quaternion {
+    float w, x, y, z;
+
+    Quaternion() : w(1), x(0), y(0), z(0) {}
+    Quaternion(float w_, float x_, float y_, float z_) : w(w_), x(x_), y(y_), z(z_) {}
+
+    Quaternion operator*(const Quaternion& q) const {
+        return Quaternion(
+            w*q.w - x*q.x - y*q.y - z*q.z,
+            w*q.x + x*q.w + y*q.z - z*q.y,
+            w*q.y - x*q.z + y*q.w + z*q.x,
+            w*q.z + x*q.y - y*q.x + z*q.w
+        );
+    }
+
+    // Single point, via the full q * p * q^-1 product. For more than a couple of points
+    // convert to a matrix once, or use the batched overload below.
+    Vec3 rotate(const Vec3& v) const {
+        Quaternion p(0, v.x, v.y, v.z);
+        Quaternion q = (*this) * p * conjugate();
+        return Vec3{q.x, q.y, q.z};
+    }
+
+    // Rotate count points in place with one matrix conversion: 15 flops per point instead of ~56
+    void rotate(Vec3* points, size_t count) const {
+        Mat3 r = toMatrix();
+        for (size_t i = 0; i < count; ++i) points[i] = r * points[i];
+    }
+
+    void rotate(std::vector<Vec3>& points) const { rotate(points.data(), points.size()); }
+
+    Quaternion conjugate() const {
+        return Quaternion(w, -x, -y, -z);
+    }
+
+    float dot(const Quaternion& q) const { return w*q.w + x*q.x + y*q.y + z*q.z; }
+
+    Quaternion normalized() const {
+        float n = std::sqrt(dot(*this));
+        if (n == 0) return Quaternion();
+        float inv = 1.0f / n;
+        return Quaternion(w * inv, x * inv, y * inv, z * inv);
+    }
+
+    // Rotation matrix of the quaternion; non-unit quaternions are normalized on the way
+    Mat3 toMatrix() const {
+        float n = dot(*this);
+        float s = n > 0 ? 2.0f / n : 0.0f;
+        float xx = x*x*s, yy = y*y*s, zz = z*z*s;
+        float xy = x*y*s, xz = x*z*s, yz = y*z*s;
+        float wx = w*x*s, wy = w*y*s, wz = w*z*s;
+        return Mat3{{
+            {1 - (yy + zz), xy - wz,       xz + wy},
+            {xy + wz,       1 - (xx + zz), yz - wx},
+            {xz - wy,       yz + wx,       1 - (xx + yy)}
+        }};
+    }
+};
+
+// Create a quaternion from angle and axis
+inline Quaternion angleAxis(float angle, const Vec3& axis) {
+    float s, c;
+    sinCos(angle / 2, s, c);
+    return Quaternion(c, axis.x * s, axis.y * s, axis.z * s);
+}
+
+// Normalized linear interpolation along the shorter arc. Not constant speed, but cheap and
+// close to slerp for the small per-frame steps animation uses.
+inline Quaternion nlerp(const Quaternion& a, const Quaternion& b, float t) {
+    float sign = a.dot(b) < 0 ? -1.0f : 1.0f;
+    float u = 1 - t, v = t * sign;
+    return Quaternion(a.w*u + b.w*v, a.x*u + b.x*v, a.y*u + b.y*v, a.z*u + b.z*v).normalized();
+}
+
+// Spherical linear interpolation along the shorter arc, constant angular speed
+inline Quaternion slerp(const Quaternion& a, const Quaternion& b, float t) {
+    float cosTheta = a.dot(b);
+    float sign = 1.0f;
+    if (cosTheta < 0) {
+        cosTheta = -cosTheta;
+        sign = -1.0f;
+    }
+    // Nearly parallel: sin(theta) goes to zero, nlerp is accurate there
+    if (cosTheta > 0.9995f) return nlerp(a, b, t);
+
+    float theta = std::acos(cosTheta);
+    float invSin = 1.0f / std::sin(theta);
+    float u = std::sin((1 - t) * theta) * invSin;
+    float v = std::sin(t * theta) * invSin * sign;
+    return Quaternion(a.w*u + b.w*v, a.x*u + b.x*v, a.y*u + b.y*v, a.z*u + b.z*v);
+}
+
+// Many quaternions in structure-of-arrays form, so per-component loops vectorize.
+// Meant for animating large numbers of objects at once.
+struct QuaternionBatch {
+    std::vector<float> w, x, y, z;
+
+    size_t size() const { return w.size(); }
+
+    void resize(size_t n) {
+        w.resize(n, 1.0f);
+        x.resize(n, 0.0f);
+        y.resize(n, 0.0f);
+        z.resize(n, 0.0f);
+    }
+
+    void set(size_t i, const Quaternion& q) { w[i] = q.w; x[i] = q.x; y[i] = q.y; z[i] = q.z; }
+    Quaternion get(size_t i) const { return Quaternion(w[i], x[i], y[i], z[i]); }
+
+    void normalize() {
+        for (size_t i = 0; i < size(); ++i) {
+            float n = w[i]*w[i] + x[i]*x[i] + y[i]*y[i] + z[i]*z[i];
+            float inv = n > 0 ? 1.0f / std::sqrt(n) : 0.0f;
+            w[i] *= inv; x[i] *= inv; y[i] *= inv; z[i] *= inv;
+        }
+    }
+
+    // out[i] = a[i] * b[i]; out may alias a or b
+    static void multiply(const QuaternionBatch& a, const QuaternionBatch& b, QuaternionBatch& out) {
+        size_t n = a.size();
+        out.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            float qw = a.w[i]*b.w[i] - a.x[i]*b.x[i] - a.y[i]*b.y[i] - a.z[i]*b.z[i];
+            float qx = a.w[i]*b.x[i] + a.x[i]*b.w[i] + a.y[i]*b.z[i] - a.z[i]*b.y[i];
+            float qy = a.w[i]*b.y[i] - a.x[i]*b.z[i] + a.y[i]*b.w[i] + a.z[i]*b.x[i];
+            float qz = a.w[i]*b.z[i] + a.x[i]*b.y[i] - a.y[i]*b.x[i] + a.z[i]*b.w[i];
+            out.w[i] = qw; out.x[i] = qx; out.y[i] = qy; out.z[i] = qz;
+        }
+    }
+
+    // out[i] = nlerp(a[i], b[i], t); out may alias a or b
+    static void nlerp(const QuaternionBatch& a, const QuaternionBatch& b, float t, QuaternionBatch& out) {
+        size_t n = a.size();
+        out.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            float d = a.w[i]*b.w[i] + a.x[i]*b.x[i] + a.y[i]*b.y[i] + a.z[i]*b.z[i];
+            float v = d < 0 ? -t : t;
+            float u = 1 - t;
+            out.w[i] = a.w[i]*u + b.w[i]*v;
+            out.x[i] = a.x[i]*u + b.x[i]*v;
+            out.y[i] = a.y[i]*u + b.y[i]*v;
+            out.z[i] = a.z[i]*u + b.z[i]*v;
+        }
+        out.normalize();
+    }
+
+    // out[i] = slerp(a[i], b[i], t)
+    static void slerp(const QuaternionBatch& a, const QuaternionBatch& b, float t, QuaternionBatch& out) {
+        size_t n = a.size();
+        out.resize(n);
+        for (size_t i = 0; i < n; ++i) out.set(i, ::slerp(a.get(i), b.get(i), t));
+    }
+
+    // One rotation matrix per quaternion
+    void toMatrices(std::vector<Mat3>& out) const {
+        out.resize(size());
+        for (size_t i = 0; i < size(); ++i) out[i] = get(i).toMatrix();
+    }
+};
@@ -0,0 +1,219 @@
+#pragma once
+#include "depthBuffer.h"
+#include "framebuffer.h"
+#include "parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Screen-space vertex for the triangle rasterizer: position in pixels, z = 1/viewZ, color 0-255
+struct RasterVertex {
+    float x, y, z;
+    float r, g, b;
+};
+
+enum class Shading { Flat, Smooth };
+
+// Half-space triangle rasterizer with depth testing.
+// submit() sets up each triangle and bins it into 64x64 tiles; flush() rasterizes the tiles on several
+// threads. Every tile walks its triangles in submission order, so the result matches a serial draw.
+// Inside a tile, 8x8 blocks are rejected or accepted from their corners, and partially covered blocks
+// evaluate the edge functions for a row of 8 pixels at once in fixed-width loops the compiler can vectorize.
+class TriangleRasterizer {
+public:
+    static constexpr int SUBPIXEL_BITS = 4;
+    static constexpr int SUBPIXEL = 1 << SUBPIXEL_BITS;
+    static constexpr int BLOCK = 8;
+    static constexpr int TILE_SHIFT = 6;
+    static constexpr int TILE = 1 << TILE_SHIFT;
+    static constexpr float GUARD_BAND = 8192.0f; // keeps the fixed-point edge functions in range
+    static constexpr int MIN_PARALLEL_TRIANGLES = 256;
+
+    // Start a batch clipped to [0, w) x [0, h), normally the framebuffer viewport
+    void begin(int w, int h) {
+        clipW = w;
+        clipH = h;
+        tilesX = (w + TILE - 1) >> TILE_SHIFT;
+        tilesY = (h + TILE - 1) >> TILE_SHIFT;
+        triangles.clear();
+        bins.resize(static_cast<size_t>(tilesX) * tilesY);
+        for (auto& bin : bins) bin.clear();
+    }
+
+    // Flat shading uses the color of the first vertex
+    void submit(const RasterVertex& v0, const RasterVertex& v1, const RasterVertex& v2, Shading shading = Shading::Smooth) {
+        const RasterVertex* v[3] = {&v0, &v1, &v2};
+        for (auto* p : v) {
+            if (p->z <= 0 || std::fabs(p->x) > GUARD_BAND || std::fabs(p->y) > GUARD_BAND) return;
+        }
+
+        int64_t X[3], Y[3];
+        for (int i = 0; i < 3; ++i) {
+            X[i] = static_cast<int64_t>(std::lround(v[i]->x * SUBPIXEL));
+            Y[i] = static_cast<int64_t>(std::lround(v[i]->y * SUBPIXEL));
+        }
+
+        // Make the edge functions positive inside whatever the winding
+        int64_t area = (X[1] - X[0]) * (Y[2] - Y[0]) - (Y[1] - Y[0]) * (X[2] - X[0]);
+        if (area == 0) return;
+        if (area < 0) {
+            std::swap(v[1], v[2]);
+            std::swap(X[1], X[2]);
+            std::swap(Y[1], Y[2]);
+            area = -area;
+        }
+
+        Triangle t;
+        for (int i = 0; i < 3; ++i) {
+            int j = (i + 1) % 3;
+            t.ea[i] = Y[i] - Y[j];
+            t.eb[i] = X[j] - X[i];
+            t.ec[i] = -(t.ea[i] * X[i] + t.eb[i] * Y[i]);
+            // Top-left fill rule: pixels exactly on other edges belong to the neighbouring triangle
+            bool topLeft = t.ea[i] > 0 || (t.ea[i] == 0 && t.eb[i] > 0);
+            if (!topLeft) t.ec[i] -= 1;
+        }
+
+        t.minX = std::max(0, static_cast<int>(std::floor(std::min({v[0]->x, v[1]->x, v[2]->x}))));
+        t.maxX = std::min(clipW - 1, static_cast<int>(std::ceil(std::max({v[0]->x, v[1]->x, v[2]->x}))));
+        t.minY = std::max(0, static_cast<int>(std::floor(std::min({v[0]->y, v[1]->y, v[2]->y}))));
+        t.maxY = std::min(clipH - 1, static_cast<int>(std::ceil(std::max({v[0]->y, v[1]->y, v[2]->y}))));
+        if (t.minX > t.maxX || t.minY > t.maxY) return;
+
+        // Attribute planes over the snapped positions, sampled at pixel centers
+        float x0 = static_cast<float>(X[0]) / SUBPIXEL, y0 = static_cast<float>(Y[0]) / SUBPIXEL;
+        float x1 = static_cast<float>(X[1]) / SUBPIXEL - x0, y1 = static_cast<float>(Y[1]) / SUBPIXEL - y0;
+        float x2 = static_cast<float>(X[2]) / SUBPIXEL - x0, y2 = static_cast<float>(Y[2]) / SUBPIXEL - y0;
+        float invArea = 1.0f / (x1 * y2 - x2 * y1);
+        auto gradient = [&](float f0, float f1, float f2) {
+            Gradient g;
+            g.dx = ((f1 - f0) * y2 - (f2 - f0) * y1) * invArea;
+            g.dy = ((f2 - f0) * x1 - (f1 - f0) * x2) * invArea;
+            g.c = f0 + g.dx * (0.5f - x0) + g.dy * (0.5f - y0);
+            return g;
+        };
+        t.z = gradient(v[0]->z, v[1]->z, v[2]->z);
+        t.flat = shading == Shading::Flat;
+        if (t.flat) {
+            t.flatColor = packColor(static_cast<int>(v0.r), static_cast<int>(v0.g), static_cast<int>(v0.b));
+        } else {
+            t.r = gradient(v[0]->r, v[1]->r, v[2]->r);
+            t.g = gradient(v[0]->g, v[1]->g, v[2]->g);
+            t.b = gradient(v[0]->b, v[1]->b, v[2]->b);
+        }
+
+        int index = static_cast<int>(triangles.size());
+        triangles.push_back(t);
+        for (int ty = t.minY >> TILE_SHIFT; ty <= t.maxY >> TILE_SHIFT; ++ty) {
+            for (int tx = t.minX >> TILE_SHIFT; tx <= t.maxX >> TILE_SHIFT; ++tx) {
+                bins[static_cast<size_t>(ty) * tilesX + tx].push_back(index);
+            }
+        }
+    }
+
+    // Rasterize everything submitted since begin(). depth may be null to skip depth testing;
+    // colorWrite = false gives a depth-only pass.
+    void flush(Framebuffer& fb, DepthBuffer* depth, bool colorWrite = true, int threadCount = 0) {
+        if (triangles.size() < MIN_PARALLEL_TRIANGLES) threadCount = 1;
+        parallelFor(tilesX * tilesY, [&](int tile) {
+            int tx = tile % tilesX, ty = tile / tilesX;
+            for (int index : bins[tile]) {
+                drawInTile(triangles[index], tx << TILE_SHIFT, ty << TILE_SHIFT, fb, depth, colorWrite);
+            }
+        }, threadCount);
+    }
+
+private:
+    // Attribute value = c + dx * x + dy * y at the center of pixel (x, y)
+    struct Gradient {
+        float dx = 0, dy = 0, c = 0;
+        float at(int x, int y) const { return c + dx * x + dy * y; }
+    };
+
+    struct Triangle {
+        int64_t ea[3], eb[3], ec[3]; // edge i: ea*X + eb*Y + ec >= 0 inside, in subpixel units
+        int minX, minY, maxX, maxY;
+        Gradient z, r, g, b;
+        bool flat;
+        uint32_t flatColor;
+    };
+
+    int clipW = 0, clipH = 0;
+    int tilesX = 0, tilesY = 0;
+    std::vector<Triangle> triangles;
+    std::vector<std::vector<int>> bins;
+
+    static uint8_t channel(float v) {
+        return static_cast<uint8_t>(std::min(std::max(v, 0.0f), 255.0f));
+    }
+
+    void drawInTile(const Triangle& t, int tileX, int tileY, Framebuffer& fb, DepthBuffer* depth, bool colorWrite) const {
+        int x0 = std::max(t.minX, tileX) & ~(BLOCK - 1);
+        int y0 = std::max(t.minY, tileY) & ~(BLOCK - 1);
+        int x1 = std::min(t.maxX, tileX + TILE - 1);
+        int y1 = std::min(t.maxY, tileY + TILE - 1);
+        for (int by = y0; by <= y1; by += BLOCK) {
+            for (int bx = x0; bx <= x1; bx += BLOCK) drawBlock(t, bx, by, fb, depth, colorWrite);
+        }
+    }
+
+    void drawBlock(const Triangle& t, int bx, int by, Framebuffer& fb, DepthBuffer* depth, bool colorWrite) const {
+        constexpr int64_t SPAN = (BLOCK - 1) * SUBPIXEL;
+
+        // Classify the block against each edge from its corner pixel centers.
+        // An edge that crosses the block has small values inside it, so 32 bits are enough there;
+        // edges that accept the whole block are dropped from the per-pixel test.
+        int32_t start[3], stepX[3], stepY[3];
+        for (int i = 0; i < 3; ++i) {
+            int64_t e = t.ea[i] * (bx * SUBPIXEL + SUBPIXEL / 2) + t.eb[i] * (by * SUBPIXEL + SUBPIXEL / 2) + t.ec[i];
+            int64_t ex = t.ea[i] * SPAN, ey = t.eb[i] * SPAN;
+            int64_t lo = e + std::min<int64_t>(ex, 0) + std::min<int64_t>(ey, 0);
+            int64_t hi = e + std::max<int64_t>(ex, 0) + std::max<int64_t>(ey, 0);
+            if (hi < 0) return;
+            if (lo >= 0) {
+                start[i] = stepX[i] = stepY[i] = 0;
+            } else {
+                start[i] = static_cast<int32_t>(e);
+                stepX[i] = static_cast<int32_t>(t.ea[i] * SUBPIXEL);
+                stepY[i] = static_cast<int32_t>(t.eb[i] * SUBPIXEL);
+            }
+        }
+
+        int width = std::min(BLOCK, clipW - bx);
+        int height = std::min(BLOCK, clipH - by);
+
+        for (int row = 0; row < height; ++row) {
+            int y = by + row;
+
+            bool covered[BLOCK];
+            float z[BLOCK];
+            float zRow = t.z.at(bx, y);
+            for (int k = 0; k < BLOCK; ++k) {
+                int32_t e = (start[0] + k * stepX[0]) | (start[1] + k * stepX[1]) | (start[2] + k * stepX[2]);
+                covered[k] = e >= 0 && k < width;
+                z[k] = zRow + k * t.z.dx;
+            }
+
+            if (depth) {
+                float* depthRow = depth->row(y) + bx;
+                for (int k = 0; k < width; ++k) {
+                    covered[k] = covered[k] && z[k] > depthRow[k];
+                    if (covered[k]) depthRow[k] = z[k];
+                }
+            }
+
+            if (colorWrite) {
+                for (int k = 0; k < width; ++k) {
+                    if (!covered[k]) continue;
+                    int x = bx + k;
+                    uint32_t color = t.flat ? t.flatColor
+                        : packColor(channel(t.r.at(x, y)), channel(t.g.at(x, y)), channel(t.b.at(x, y)));
+                    fb.put(x, y, color);
+                }
+            }
+
+            for (int i = 0; i < 3; ++i) start[i] += stepY[i];
+        }
+    }
+};
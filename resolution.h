@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+// Picks the internal render scale (a fraction of the window size per axis) frame by frame so the
+// frame time holds near a target. Raster cost goes with pixel count, the square of the scale,
+// so a frame that took measured ms at scale s would take target ms at s * sqrt(target / measured).
+//
+// Load spikes react on the same frame: anything over the target scales down at once. Going back
+// up needs UPSCALE_FRAMES frames in a row with headroom and then moves one SCALE_STEP, so the
+// scale does not bounce between two sizes. The scale is quantized to SCALE_STEP, which keeps the
+// number of distinct render sizes (and buffer resizes) small.
+class ResolutionController {
+public:
+    static constexpr float SCALE_STEP = 1.0f / 16;
+    static constexpr float HEADROOM = 0.8f;   // upscale only while frames take less than this part of the target
+    static constexpr int UPSCALE_FRAMES = 30;
+    static constexpr float SMOOTHING = 0.25f; // weight of the newest frame in the running average
+
+    explicit ResolutionController(float targetMs, float minScale = 0.5f, float maxScale = 1.0f)
+        : targetMs(targetMs), minScale(minScale), maxScale(maxScale), current(maxScale) {}
+
+    // Feed the time the last frame spent rendering (before present, so vsync waits are not counted)
+    void update(float frameMs) {
+        averageMs = averageMs > 0 ? averageMs + (frameMs - averageMs) * SMOOTHING : frameMs;
+
+        // A spike is judged on the raw time, steady load on the average
+        float measured = std::max(frameMs, averageMs);
+        if (measured > targetMs) {
+            float old = current;
+            float wanted = current * std::sqrt(targetMs / measured);
+            setScale(std::floor(wanted / SCALE_STEP) * SCALE_STEP);
+            // Restart the average at what the new size should cost, so the old size's slow
+            // frames do not push the scale down again
+            float ratio = current / old;
+            averageMs = frameMs * ratio * ratio;
+            headroomFrames = 0;
+            return;
+        }
+
+        headroomFrames = averageMs < targetMs * HEADROOM ? headroomFrames + 1 : 0;
+        if (headroomFrames >= UPSCALE_FRAMES) {
+            setScale(current + SCALE_STEP);
+            headroomFrames = 0;
+        }
+    }
+
+    float scale() const { return current; }
+    bool atMinimum() const { return current <= minScale; }
+    bool atMaximum() const { return current >= maxScale; }
+    float target() const { return targetMs; }
+    float averageFrameMs() const { return averageMs; }
+
+    // Render size along an axis of fullSize pixels at the current scale, rounded to even pixels
+    // so the size still splits evenly into halves
+    int size(int fullSize) const {
+        return std::max(2, static_cast<int>(std::lround(fullSize * current / 2)) * 2);
+    }
+
+    // Fixed scale, e.g. with dynamic resolution switched off
+    void reset(float scale = 1.0f) {
+        current = std::clamp(scale, minScale, maxScale);
+        averageMs = 0;
+        headroomFrames = 0;
+    }
+
+private:
+    void setScale(float scale) {
+        current = std::clamp(scale, minScale, maxScale);
+    }
+
+    float targetMs, minScale, maxScale;
+    float current;
+    float averageMs = 0;
+    int headroomFrames = 0;
+};
@@ -1,57 +1,293 @@
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
 #include <vector>
 #include <iostream>
 
 
+// Points are given in a fixed LOGICAL_WIDTH x LOGICAL_HEIGHT space and drawn into an offscreen
+// target at the internal render size, which is scaled up to the window once per show().
+// The render size can change at run time (setRenderSize) without touching the coordinates.
+constexpr int LOGICAL_WIDTH = 640;
+constexpr int LOGICAL_HEIGHT = 480;
+constexpr int WINDOW_SCALE = 2;
+
+// Submitted points are stored packed in 32 bits: the render pixel index y * width + x in the low
+// POINT_INDEX_BITS and an RGB332 color in the top 8. They become SDL points only in show(), one
+// small chunk at a time, so point-heavy frames move 4 bytes per point instead of 8.
+constexpr int POINT_INDEX_BITS = 24;
+constexpr uint32_t POINT_INDEX_MASK = (1u << POINT_INDEX_BITS) - 1;
+constexpr int POINT_CHUNK = 4096; // points decoded per SDL call
+static_assert(LOGICAL_WIDTH * WINDOW_SCALE * LOGICAL_HEIGHT * WINDOW_SCALE <= POINT_INDEX_MASK + 1,
+              "window pixel index must fit in POINT_INDEX_BITS");
+
+inline uint8_t packColor332(uint32_t argb) {
+    return static_cast<uint8_t>(((argb >> 16) & 0xE0) | ((argb >> 11) & 0x1C) | ((argb >> 6) & 0x03));
+}
+
+// Logical coordinates to packed points on the render pixel grid
+struct PointGrid {
+    int width = 0, height = 0;
+    float scaleX = 1, scaleY = 1; // logical to render pixels
+
+    // False for points off the grid
+    bool pack(float x, float y, uint8_t color, uint32_t& packed) const {
+        float fx = x * scaleX, fy = y * scaleY;
+        if (!(fx >= 0 && fy >= 0 && fx < width && fy < height)) return false;
+        packed = static_cast<uint32_t>(color) << POINT_INDEX_BITS |
+                 (static_cast<uint32_t>(fy) * static_cast<uint32_t>(width) + static_cast<uint32_t>(fx));
+        return true;
+    }
+};
+
+// Points from one worker thread. A thread that owns a bin appends to it without locking;
+// Screen draws every bin in show(). Cache-line aligned so neighbouring bins do not share one.
+class alignas(64) PointBin {
+    const PointGrid* grid = nullptr;
+    std::vector<uint32_t> points;
+    size_t submitted = 0;
+    friend class Screen;
+
+public:
+    void pixel(float x, float y, uint32_t color = 0xFFFFFFFF) {
+        submitted++;
+        uint32_t packed;
+        if (grid->pack(x, y, packColor332(color), packed)) points.push_back(packed);
+    }
+    size_t size() const { return points.size(); }
+};
+
+// Points submitted and drawn in the last shown frame. With deduplication on, each render pixel
+// is drawn at most once, so overdraw() is how many submissions landed on an average drawn pixel.
+struct PointStats {
+    size_t submitted = 0;
+    size_t drawn = 0;
+    float overdraw() const { return drawn > 0 ? static_cast<float>(submitted) / drawn : 1.0f; }
+};
+
 class Screen{
     SDL_Event e;
     SDL_Window* window;
     SDL_Renderer* renderer;
-    std::vector<SDL_FPoint> points;
-    
+    SDL_Texture* target = nullptr; // null when the renderer cannot render to textures
+    int renderW = 0, renderH = 0;
+    PointGrid grid;
+    std::vector<uint32_t> points;
+    std::vector<PointBin> bins;
+    std::vector<uint32_t> sorted;  // points grouped by color, when a frame has several
+    std::vector<SDL_Point> decoded;
+
+    // Optional 1 bit per grid pixel occupancy mask, indexed like the packed points
+    bool deduplicate = false;
+    std::vector<uint64_t> occupancy;
+    size_t submitted = 0;
+    PointStats lastStats;
+
 public:
-    Screen()
+    Screen(int renderWidth = LOGICAL_WIDTH, int renderHeight = LOGICAL_HEIGHT)
     {
         if (SDL_Init(SDL_INIT_VIDEO) != 0) {
             std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
             exit(1);  // Exit if SDL fails to initialize
         }
 
-        if (SDL_CreateWindowAndRenderer(640 * 2, 480 * 2, 0, &window, &renderer) != 0) {
+        if (SDL_CreateWindowAndRenderer(LOGICAL_WIDTH * WINDOW_SCALE, LOGICAL_HEIGHT * WINDOW_SCALE, 0, &window, &renderer) != 0) {
             std::cerr << "Window/Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
             SDL_Quit();
             exit(1);  // Exit if window/renderer creation fails
         }
 
-        SDL_RenderSetScale(renderer, 2, 2);
+        decoded.resize(POINT_CHUNK);
+        setRenderSize(renderWidth, renderHeight);
     }
 
     ~Screen() {
+        if (target) SDL_DestroyTexture(target);
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
         SDL_Quit();  // Clean up SDL when the object is destroyed
     }
 
-    void pixel(float x, float y) {
-        SDL_FPoint point = {x, y};  // Explicitly create an SDL_FPoint
-        points.emplace_back(point);  //pushback emplace_back
+    // Internal resolution, up to the window size. Without render target support the points stay
+    // on the logical grid and are drawn onto the window at WINDOW_SCALE, as WINDOW_SCALE-sized
+    // blocks. Call between frames: points already submitted are stored on the old size's grid.
+    void setRenderSize(int w, int h) {
+        w = std::clamp(w, 1, LOGICAL_WIDTH * WINDOW_SCALE);
+        h = std::clamp(h, 1, LOGICAL_HEIGHT * WINDOW_SCALE);
+        if (w == renderW && h == renderH) return;
+        renderW = w;
+        renderH = h;
+
+        if (target) SDL_DestroyTexture(target);
+        target = nullptr;
+        if (SDL_RenderTargetSupported(renderer)) {
+            target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, w, h);
+        }
+
+        grid.width = target ? renderW : LOGICAL_WIDTH;
+        grid.height = target ? renderH : LOGICAL_HEIGHT;
+        grid.scaleX = static_cast<float>(grid.width) / LOGICAL_WIDTH;
+        grid.scaleY = static_cast<float>(grid.height) / LOGICAL_HEIGHT;
+        resizeMask();
+    }
+
+    // Drop points that land on a render pixel already drawn this frame
+    void setDeduplicate(bool on) {
+        deduplicate = on;
+        resizeMask();
+    }
+    bool deduplicating() const { return deduplicate; }
+
+    const PointStats& stats() const { return lastStats; }
+
+    void setTitle(const std::string& title) { SDL_SetWindowTitle(window, title.c_str()); }
+
+    int renderWidth() const { return renderW; }
+    int renderHeight() const { return renderH; }
+
+    // Bins for parallel submission: worker i writes to bin(i) only. Resize between frames,
+    // never while workers are writing.
+    void setBinCount(int count) {
+        bins.resize(std::max(count, 0));
+        for (auto& bin : bins) bin.grid = &grid;
+    }
+    int binCount() const { return static_cast<int>(bins.size()); }
+    PointBin& bin(int i) { return bins[i]; }
+
+    // Main thread only; workers use their own bin. Colors are ARGB, kept at RGB332 precision.
+    void pixel(float x, float y, uint32_t color = 0xFFFFFFFF) {
+        submitted++;
+        uint32_t packed;
+        if (!grid.pack(x, y, packColor332(color), packed)) return;
+        if (deduplicate && !claim(packed)) return;
+        points.push_back(packed);
     }
 
     void show(){
+        if (target) SDL_SetRenderTarget(renderer, target);
+        // Grid pixels are render pixels with a target, logical pixels without one
+        float scale = target ? 1.0f : static_cast<float>(WINDOW_SCALE);
+        SDL_RenderSetScale(renderer, scale, scale);
         SDL_SetRenderDrawColor(renderer,0,0,0,255);
         SDL_RenderClear(renderer);
 
-        SDL_SetRenderDrawColor(renderer,255,255,255,255);
-        for(auto& point:points){
-            SDL_RenderDrawPointF(renderer,point.x, point.y);
+        // Bins are filled without the mask, so they are deduplicated here
+        lastStats.submitted = submitted;
+        lastStats.drawn = points.size();
+        for (auto& bin : bins) {
+            lastStats.submitted += bin.submitted;
+            if (deduplicate) {
+                auto kept = std::remove_if(bin.points.begin(), bin.points.end(), [&](uint32_t p) { return !claim(p); });
+                bin.points.erase(kept, bin.points.end());
+            }
+            lastStats.drawn += bin.points.size();
+        }
+
+        drawPackedPoints();
+
+        // One scaled copy of the whole frame onto the window
+        if (target) {
+            SDL_SetRenderTarget(renderer, nullptr);
+            SDL_RenderCopy(renderer, target, nullptr, nullptr);
         }
         SDL_RenderPresent(renderer);
     }
-
     void clear(){
         points.clear();
+        for (auto& bin : bins) {
+            bin.points.clear();
+            bin.submitted = 0;
+        }
+        submitted = 0;
+        if (deduplicate) std::memset(occupancy.data(), 0, occupancy.size() * sizeof(uint64_t));
+    }
+
+private:
+    void resizeMask() {
+        if (!deduplicate) {
+            occupancy = std::vector<uint64_t>();
+            return;
+        }
+        occupancy.assign((static_cast<size_t>(grid.width) * grid.height + 63) / 64, 0);
+    }
+
+    // Sets the point's pixel in the mask; false if it was already set
+    bool claim(uint32_t packed) {
+        uint32_t index = packed & POINT_INDEX_MASK;
+        uint64_t& word = occupancy[index >> 6];
+        uint64_t bit = uint64_t(1) << (index & 63);
+        if (word & bit) return false;
+        word |= bit;
+        return true;
+    }
+
+    // The backend boundary: packed points are unpacked into SDL_Points here, POINT_CHUNK at a
+    // time, with one SDL call per chunk and one draw color change per color present
+    void drawPackedPoints() {
+        size_t counts[256] = {};
+        auto countColors = [&](const std::vector<uint32_t>& list) {
+            for (uint32_t p : list) counts[p >> POINT_INDEX_BITS]++;
+        };
+        countColors(points);
+        for (auto& bin : bins) countColors(bin.points);
+
+        int colors = 0, onlyColor = 0;
+        for (int c = 0; c < 256; ++c) {
+            if (counts[c] == 0) continue;
+            colors++;
+            onlyColor = c;
+        }
+        if (colors == 0) return;
+
+        // One color (the usual all-white frame) draws each list as it is
+        if (colors == 1) {
+            setDrawColor332(onlyColor);
+            drawPackedRun(points.data(), points.size());
+            for (auto& bin : bins) drawPackedRun(bin.points.data(), bin.points.size());
+            return;
+        }
+
+        // Otherwise a counting sort by color, then one run per color
+        size_t starts[256], next[256], total = 0;
+        for (int c = 0; c < 256; ++c) {
+            starts[c] = next[c] = total;
+            total += counts[c];
+        }
+        sorted.resize(total);
+        auto scatter = [&](const std::vector<uint32_t>& list) {
+            for (uint32_t p : list) sorted[next[p >> POINT_INDEX_BITS]++] = p;
+        };
+        scatter(points);
+        for (auto& bin : bins) scatter(bin.points);
+
+        for (int c = 0; c < 256; ++c) {
+            if (counts[c] == 0) continue;
+            setDrawColor332(c);
+            drawPackedRun(sorted.data() + starts[c], counts[c]);
+        }
     }
 
+    void drawPackedRun(const uint32_t* packed, size_t count) {
+        uint32_t width = static_cast<uint32_t>(grid.width);
+        for (size_t i = 0; i < count; i += POINT_CHUNK) {
+            int n = static_cast<int>(std::min<size_t>(POINT_CHUNK, count - i));
+            for (int k = 0; k < n; ++k) {
+                uint32_t index = packed[i + k] & POINT_INDEX_MASK;
+                uint32_t y = index / width;
+                decoded[k] = SDL_Point{static_cast<int>(index - y * width), static_cast<int>(y)};
+            }
+            SDL_RenderDrawPoints(renderer, decoded.data(), n);
+        }
+    }
+
+    void setDrawColor332(int c) {
+        SDL_SetRenderDrawColor(renderer, static_cast<Uint8>((c >> 5) * 255 / 7), static_cast<Uint8>(((c >> 2) & 7) * 255 / 7),
+                               static_cast<Uint8>((c & 3) * 255 / 3), 255);
+    }
+
+public:
     void input() {
         while(SDL_PollEvent(&e)){
             if(e.type == SDL_QUIT){
@@ -0,0 +1,191 @@
+#pragma once
+#include "framebuffer.h"
+#include "vec.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Lines of any width, filled as horizontal spans straight into the framebuffer.
+// Every piece of a stroke (segment body, cap, join) is a convex polygon or a disc, and each is
+// filled one Framebuffer::fillSpan per row. A pixel is inside when its center is, so a width-w
+// horizontal line covers w rows. Strokes are opaque, so overlapping pieces just rewrite the same color.
+enum class LineCap { Butt, Square, Round };
+enum class LineJoin { Miter, Round, Bevel };
+
+constexpr float MITER_LIMIT = 4.0f; // miters longer than this many half-widths fall back to bevels
+
+// First and last pixel whose center lies in [lo, hi] on an axis of size pixels, clamped in
+// float first so far off-screen geometry cannot overflow the conversion
+inline int firstPixel(float lo) { return static_cast<int>(std::ceil(std::max(lo, -1.0f) - 0.5f)); }
+inline int lastPixel(float hi, int size) { return static_cast<int>(std::floor(std::min(hi, size + 1.0f) - 0.5f)); }
+
+// Convex polygon with up to MAX_POLYGON_POINTS corners, in either winding
+constexpr int MAX_POLYGON_POINTS = 8;
+
+inline void fillConvexPolygon(Framebuffer& fb, const Vec2* points, int count, uint32_t color) {
+    if (count < 3) return;
+    float minY = points[0].y, maxY = points[0].y;
+    for (int i = 1; i < count; ++i) {
+        minY = std::min(minY, points[i].y);
+        maxY = std::max(maxY, points[i].y);
+    }
+    int y0 = std::max(firstPixel(minY), 0);
+    int y1 = std::min(lastPixel(maxY, fb.height()), fb.height() - 1);
+
+    // Per edge: x at the first row's center and the x step per row; horizontal edges never cross a row center
+    float edgeX[MAX_POLYGON_POINTS], edgeStep[MAX_POLYGON_POINTS], edgeTop[MAX_POLYGON_POINTS], edgeBottom[MAX_POLYGON_POINTS];
+    int edges = 0;
+    for (int i = 0; i < count; ++i) {
+        Vec2 a = points[i], b = points[(i + 1) % count];
+        if (a.y == b.y) continue;
+        if (a.y > b.y) std::swap(a, b);
+        float step = (b.x - a.x) / (b.y - a.y);
+        edgeX[edges] = a.x + (y0 + 0.5f - a.y) * step;
+        edgeStep[edges] = step;
+        edgeTop[edges] = a.y;
+        edgeBottom[edges] = b.y;
+        edges++;
+    }
+
+    for (int y = y0; y <= y1; ++y) {
+        float center = y + 0.5f;
+        float left = 1e30f, right = -1e30f;
+        for (int e = 0; e < edges; ++e) {
+            if (center >= edgeTop[e] && center <= edgeBottom[e]) {
+                left = std::min(left, edgeX[e]);
+                right = std::max(right, edgeX[e]);
+            }
+            edgeX[e] += edgeStep[e];
+        }
+        if (left <= right) {
+            fb.fillSpan(y, firstPixel(left), lastPixel(right, fb.width()), color);
+        }
+    }
+}
+
+// Disc of the given radius around a sub-pixel center: one square root per row
+inline void fillDisc(Framebuffer& fb, Vec2 center, float radius, uint32_t color) {
+    if (radius <= 0) return;
+    int y0 = std::max(firstPixel(center.y - radius), 0);
+    int y1 = std::min(lastPixel(center.y + radius, fb.height()), fb.height() - 1);
+    float r2 = radius * radius;
+    for (int y = y0; y <= y1; ++y) {
+        float dy = y + 0.5f - center.y;
+        float half = std::sqrt(std::max(r2 - dy * dy, 0.0f));
+        fb.fillSpan(y, firstPixel(center.x - half), lastPixel(center.x + half, fb.width()), color);
+    }
+}
+
+// Unit normal of a -> b (zero for a degenerate segment)
+inline Vec2 segmentNormal(Vec2 a, Vec2 b) {
+    Vec2 d = b - a;
+    float length = std::sqrt(d.x * d.x + d.y * d.y);
+    return length > 0 ? Vec2{-d.y / length, d.x / length} : Vec2{0, 0};
+}
+
+// The body of a -> b, width pixels wide. Square caps stretch it by half the width at the
+// flagged ends; round caps are discs added by the caller.
+inline void fillSegmentBody(Framebuffer& fb, Vec2 a, Vec2 b, float width, uint32_t color, bool extendStart, bool extendEnd) {
+    float half = width * 0.5f;
+    Vec2 n = segmentNormal(a, b);
+    Vec2 d{n.y, -n.x}; // unit direction a -> b
+    if (extendStart) a = a - d * half;
+    if (extendEnd) b = b + d * half;
+
+    // Clip to the viewport grown by the half width, which leaves the visible part unchanged and
+    // keeps far off-screen end points from costing float precision in the edge steps
+    float margin = half + 1.0f, t0, t1;
+    if (!clipLine(a.x + margin, a.y + margin, b.x + margin, b.y + margin, fb.width() + 2 * margin, fb.height() + 2 * margin, t0, t1)) return;
+    Vec2 ab = b - a;
+    b = a + ab * t1;
+    a = a + ab * t0;
+    Vec2 offset = n * half;
+    Vec2 quad[4] = {a + offset, b + offset, b - offset, a - offset};
+    fillConvexPolygon(fb, quad, 4, color);
+}
+
+// Single thick line with the same cap at both ends
+inline void drawThickLine(Framebuffer& fb, float x0, float y0, float x1, float y1, float width, uint32_t color,
+                          LineCap cap = LineCap::Butt) {
+    if (width <= 0) return;
+    Vec2 a{x0, y0}, b{x1, y1};
+    if (a.x == b.x && a.y == b.y) {
+        // A zero-length line only shows its caps
+        float half = width * 0.5f;
+        if (cap == LineCap::Round) fillDisc(fb, a, half, color);
+        if (cap == LineCap::Square) {
+            Vec2 square[4] = {{a.x - half, a.y - half}, {a.x + half, a.y - half}, {a.x + half, a.y + half}, {a.x - half, a.y + half}};
+            fillConvexPolygon(fb, square, 4, color);
+        }
+        return;
+    }
+    bool square = cap == LineCap::Square;
+    fillSegmentBody(fb, a, b, width, color, square, square);
+    if (cap == LineCap::Round) {
+        fillDisc(fb, a, width * 0.5f, color);
+        fillDisc(fb, b, width * 0.5f, color);
+    }
+}
+
+// Fills the outside corner where segment p -> q (width w0) meets q -> r (width w1). Each segment
+// body already covers its own side, so only the wedge between the two outer edges is missing.
+inline void fillJoin(Framebuffer& fb, Vec2 p, Vec2 q, Vec2 r, float w0, float w1, uint32_t color, LineJoin join) {
+    Vec2 n0 = segmentNormal(p, q), n1 = segmentNormal(q, r);
+    float turn = n0.x * n1.y - n0.y * n1.x;
+    if (turn == 0 && n0.x * n1.x + n0.y * n1.y > 0) return; // straight on, nothing to fill
+
+    if (join == LineJoin::Round) {
+        fillDisc(fb, q, std::max(w0, w1) * 0.5f, color);
+        return;
+    }
+
+    // The outer side is the one the path turns away from
+    float side = turn > 0 ? -1.0f : 1.0f;
+    Vec2 e0 = q + n0 * (side * w0 * 0.5f);
+    Vec2 e1 = q + n1 * (side * w1 * 0.5f);
+
+    if (join == LineJoin::Miter && turn != 0) {
+        // Where the two outer edges meet: e0 + t * d0 == e1 - s * d1
+        Vec2 d0{n0.y, -n0.x}, d1{n1.y, -n1.x};
+        float denom = d0.x * d1.y - d0.y * d1.x;
+        Vec2 between = e1 - e0;
+        float t = (between.x * d1.y - between.y * d1.x) / denom;
+        Vec2 tip = e0 + d0 * t;
+        Vec2 reach = tip - q;
+        float limit = MITER_LIMIT * std::max(w0, w1) * 0.5f;
+        if (t >= 0 && reach.x * reach.x + reach.y * reach.y <= limit * limit) {
+            Vec2 corner[4] = {q, e0, tip, e1};
+            fillConvexPolygon(fb, corner, 4, color);
+            return;
+        }
+    }
+    Vec2 bevel[3] = {q, e0, e1};
+    fillConvexPolygon(fb, bevel, 3, color);
+}
+
+// Polyline through count points. widths is null for one width everywhere, otherwise it holds one
+// width per segment (count - 1 entries); caps use the width of the segment they end.
+inline void drawThickPolyline(Framebuffer& fb, const Vec2* points, int count, float width, uint32_t color,
+                              LineJoin join = LineJoin::Miter, LineCap cap = LineCap::Butt, const float* widths = nullptr) {
+    if (count < 2) return;
+    auto segmentWidth = [&](int i) { return widths ? widths[i] : width; };
+
+    int last = count - 2;
+    bool square = cap == LineCap::Square;
+    for (int i = 0; i <= last; ++i) {
+        float w = segmentWidth(i);
+        if (w <= 0) continue;
+        fillSegmentBody(fb, points[i], points[i + 1], w, color, square && i == 0, square && i == last);
+        if (i > 0 && segmentWidth(i - 1) > 0) fillJoin(fb, points[i - 1], points[i], points[i + 1], segmentWidth(i - 1), w, color, join);
+    }
+    if (cap == LineCap::Round) {
+        fillDisc(fb, points[0], segmentWidth(0) * 0.5f, color);
+        fillDisc(fb, points[count - 1], segmentWidth(last) * 0.5f, color);
+    }
+}
+
+inline void drawThickPolyline(Framebuffer& fb, const std::vector<Vec2>& points, float width, uint32_t color,
+                              LineJoin join = LineJoin::Miter, LineCap cap = LineCap::Butt) {
+    drawThickPolyline(fb, points.data(), static_cast<int>(points.size()), width, color, join, cap);
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include "vec.h"
+#include <array>
+#include <memory>
+#include <vector>
+
+// World-space positions keyed on (mesh, model transform).
+// Viewports that show the same mesh with the same model transform share one transform pass,
+// leaving only their own stages (e.g. project4D) and the camera projection per viewport.
+// Entries survive across frames, so a model whose transform did not change is not transformed again.
+class TransformCache {
+public:
+    // The mesh is identified by address; transform holds whatever parameters define the
+    // model transform (angles, quaternion components, ...), unused slots left at zero
+    struct Key {
+        const void* mesh = nullptr;
+        std::array<float, 8> transform{};
+
+        bool operator==(const Key& other) const { return mesh == other.mesh && transform == other.transform; }
+    };
+
+    // Cached positions for key, filled by transform(std::vector<Vec3>& out) on a miss.
+    // The reference stays valid until the next newFrame().
+    template <typename Fn>
+    const std::vector<Vec3>& get(const Key& key, Fn&& transform) {
+        for (auto& entry : entries) {
+            if (entry->live && entry->key == key) {
+                entry->used = true;
+                hits++;
+                return entry->positions;
+            }
+        }
+        misses++;
+
+        // Reuse the storage of an evicted entry before allocating a new one
+        Entry* slot = nullptr;
+        for (auto& entry : entries) {
+            if (!entry->live) {
+                slot = entry.get();
+                break;
+            }
+        }
+        if (!slot) {
+            entries.push_back(std::make_unique<Entry>());
+            slot = entries.back().get();
+        }
+
+        slot->key = key;
+        slot->live = true;
+        slot->used = true;
+        slot->positions.clear();
+        transform(slot->positions);
+        return slot->positions;
+    }
+
+    // Evict entries nobody asked for during the last frame, keeping their memory for reuse
+    void newFrame() {
+        for (auto& entry : entries) {
+            if (!entry->used) entry->live = false;
+            entry->used = false;
+        }
+        hits = misses = 0;
+    }
+
+    // Drop every entry of a mesh whose vertices were edited
+    void invalidate(const void* mesh) {
+        for (auto& entry : entries) {
+            if (entry->key.mesh == mesh) entry->live = false;
+        }
+    }
+
+    // Lookups served from the cache / transformed since the last newFrame()
+    int hitCount() const { return hits; }
+    int missCount() const { return misses; }
+
+private:
+    struct Entry {
+        Key key;
+        std::vector<Vec3> positions;
+        bool live = false;
+        bool used = false;
+    };
+
+    std::vector<std::unique_ptr<Entry>> entries;
+    int hits = 0, misses = 0;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <cmath>
+
+// Define a 2D vector
+struct Vec2 {
+    float x, y;
+};
+
+inline Vec2 operator+(const Vec2& a, const Vec2& b) { return Vec2{a.x + b.x, a.y + b.y}; }
+inline Vec2 operator-(const Vec2& a, const Vec2& b) { return Vec2{a.x - b.x, a.y - b.y}; }
+inline Vec2 operator*(const Vec2& v, float s) { return Vec2{v.x * s, v.y * s}; }
+
+// Define a 4D vector
+struct Vec4 {
+    float x, y, z, w;
+};
+
+// Define a 3D vector
+struct Vec3 {
+    float x, y, z;
+};
+
+inline Vec3 operator+(const Vec3& a, const Vec3& b) { return Vec3{a.x + b.x, a.y + b.y, a.z + b.z}; }
+inline Vec3 operator-(const Vec3& a, const Vec3& b) { return Vec3{a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline Vec3 operator*(const Vec3& v, float s) { return Vec3{v.x * s, v.y * s, v.z * s}; }
+
+inline float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+    return Vec3{
+        a.y * b.z - a.z * b.y,
+        a.z * b.x - a.x * b.z,
+        a.x * b.y - a.y * b.x
+    };
+}
+
+inline float length(const Vec3& v) { return std::sqrt(dot(v, v)); }
+
+// Component-wise min/max, used for bounding boxes
+inline Vec3 minVec(const Vec3& a, const Vec3& b) {
+    return Vec3{a.x < b.x ? a.x : b.x, a.y < b.y ? a.y : b.y, a.z < b.z ? a.z : b.z};
+}
+
+inline Vec3 maxVec(const Vec3& a, const Vec3& b) {
+    return Vec3{a.x > b.x ? a.x : b.x, a.y > b.y ? a.y : b.y, a.z > b.z ? a.z : b.z};
+}